@@ -87,7 +87,7 @@ ColumnLayout {
 
                 Rectangle {
                     anchors.fill: parent
-                    anchors.rightMargin: 80
+                    anchors.rightMargin: 160
                     color: "transparent"
                     property var trusted: remoteNodesModel.get(index) ? remoteNodesModel.get(index).trusted : false
 
@@ -136,6 +136,18 @@ ColumnLayout {
                     height: 30
                     spacing: 2
 
+                    MoneroComponents.TextPlain {
+                        property var health: remoteNodeHealth.scores[index]
+                        visible: health !== undefined && health.probed
+                        color: MoneroComponents.Style.dimmedFontColor
+                        font.pixelSize: 12
+                        themeTransition: false
+                        text: !visible ? "" : health.online
+                            ? qsTr("%1 ms").arg(health.latency) + (health.heightLag > 0 ? " " + qsTr("(%1 blocks behind)").arg(health.heightLag) : "") + translationManager.emptyString
+                            : qsTr("offline") + translationManager.emptyString
+                        tooltip: visible ? (health.online ? health.version : health.error) : ""
+                    }
+
                     MoneroComponents.InlineButton {
                         buttonColor: "transparent"
                         fontFamily: FontAwesome.fontFamily
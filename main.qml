@@ -36,7 +36,8 @@ import QtGraphicalEffects 1.0
 
 import FontAwesome 1.0
 
-import moneroComponents.Network 1.0
+import moneroComponents.PriceFeed 1.0
+import moneroComponents.RemoteNodeHealth 1.0
 import moneroComponents.Wallet 1.0
 import moneroComponents.WalletManager 1.0
 import moneroComponents.PendingTransaction 1.0
@@ -101,23 +102,7 @@ ApplicationWindow {
     property bool themeTransition: false
 
     // fiat price conversion
-    property real fiatPrice: 0
-    property var fiatPriceAPIs: {
-        return {
-            "kraken": {
-                "xmrusd": "https://api.kraken.com/0/public/Ticker?pair=XMRUSD",
-                "xmreur": "https://api.kraken.com/0/public/Ticker?pair=XMREUR"
-            },
-            "coingecko": {
-                "xmrusd": "https://api.coingecko.com/api/v3/simple/price?ids=monero&vs_currencies=usd",
-                "xmreur": "https://api.coingecko.com/api/v3/simple/price?ids=monero&vs_currencies=eur"
-            },
-            "cryptocompare": {
-                "xmrusd": "https://min-api.cryptocompare.com/data/price?fsym=XMR&tsyms=USD",
-                "xmreur": "https://min-api.cryptocompare.com/data/price?fsym=XMR&tsyms=EUR",
-            }
-        }
-    }
+    property real fiatPrice: priceFeed.price
 
     // true if wallet ever synchronized
     property bool walletInitialized : false
@@ -373,6 +358,7 @@ ApplicationWindow {
             persistentSettings.is_recovering_from_device,
             persistentSettings.restore_height,
             persistentSettings.getWalletProxyAddress());
+        updateChainNotifications();
 
         // save wallet keys in case wallet settings have been changed in the init
         currentWallet.setPassword(walletPassword);
@@ -477,7 +463,7 @@ ApplicationWindow {
         }
         // initialize transaction history once wallet is initialized first time;
         if (!walletInitialized) {
-            currentWallet.history.refresh(currentWallet.currentSubaddressAccount)
+            currentWallet.history.refreshAsync(currentWallet.currentSubaddressAccount)
             walletInitialized = true
 
             // check if daemon was already mining and add mining logo if true
@@ -595,10 +581,7 @@ ApplicationWindow {
         if(foundNewBlock) {
             foundNewBlock = false;
             console.log("New block found - updating history")
-            currentWallet.history.refresh(currentWallet.currentSubaddressAccount)
-
-            if(middlePanel.state == "History")
-                middlePanel.historyView.update();
+            currentWallet.history.refreshAsync(currentWallet.currentSubaddressAccount)
         }
     }
 
@@ -621,6 +604,7 @@ ApplicationWindow {
                 false,
                 0,
                 persistentSettings.getWalletProxyAddress());
+            updateChainNotifications();
             walletManager.setDaemonAddressAsync(currentDaemonAddress);
         };
 
@@ -651,6 +635,7 @@ ApplicationWindow {
             false,
             0,
             persistentSettings.getWalletProxyAddress());
+        updateChainNotifications();
         walletManager.setDaemonAddressAsync(currentDaemonAddress);
         firstBlockSeen = 0;
     }
@@ -693,7 +678,7 @@ ApplicationWindow {
 
         // Update history on every refresh if it's empty
         if(currentWallet.history.count == 0)
-            currentWallet.history.refresh(currentWallet.currentSubaddressAccount)
+            currentWallet.history.refreshAsync(currentWallet.currentSubaddressAccount)
 
         onWalletUpdate();
     }
@@ -739,6 +724,8 @@ ApplicationWindow {
         daemonStartStopInProgress = 0;
         if (currentWallet) {
             currentWallet.connected(true);
+            // the daemon's flags may have moved its chain events endpoint
+            updateChainNotifications();
             // resume refresh
             currentWallet.startRefresh();
         }
@@ -788,29 +775,20 @@ ApplicationWindow {
         // refresh transaction history here
         console.log("Confirmed money found")
         // history refresh is handled by walletUpdated
-        currentWallet.history.refresh(currentWallet.currentSubaddressAccount) // this will refresh model
+        currentWallet.history.refreshAsync(currentWallet.currentSubaddressAccount) // this will refresh model
         currentWallet.subaddress.refresh(currentWallet.currentSubaddressAccount)
-
-        if(middlePanel.state == "History")
-            middlePanel.historyView.update();
     }
 
     function onWalletUnconfirmedMoneyReceived(txId, amount) {
         // refresh history
         console.log("unconfirmed money found")
-        currentWallet.history.refresh(currentWallet.currentSubaddressAccount);
-
-        if(middlePanel.state == "History")
-            middlePanel.historyView.update();
+        currentWallet.history.refreshAsync(currentWallet.currentSubaddressAccount);
     }
 
     function onWalletMoneySent(txId, amount) {
         // refresh transaction history here
         console.log("monero sent found")
-        currentWallet.history.refresh(currentWallet.currentSubaddressAccount); // this will refresh model
-
-        if(middlePanel.state == "History")
-            middlePanel.historyView.update();
+        currentWallet.history.refreshAsync(currentWallet.currentSubaddressAccount); // this will refresh model
     }
 
     function walletsFound() {
@@ -1143,6 +1121,7 @@ ApplicationWindow {
 
     objectName: "appWindow"
     visible: true
+    onVisibilityChanged: updateRefreshActivity()
     width: screenAvailableWidth > 980
         ? 980
         : Math.min(screenAvailableWidth, 800)
@@ -1152,112 +1131,6 @@ ApplicationWindow {
     color: MoneroComponents.Style.appWindowBackgroundColor
     flags: persistentSettings.customDecorations ? Windows.flagsCustomDecorations : Windows.flags
 
-    Timer {
-        id: fiatPriceTimer
-        interval: 1000 * 60;
-        running: persistentSettings.fiatPriceEnabled && currentWallet !== undefined
-        repeat: true
-        onTriggered: appWindow.fiatApiRefresh()
-        triggeredOnStart: true
-    }
-
-    function fiatApiParseTicker(url, resp, currency){
-        // parse & validate incoming JSON
-        if(url.startsWith("https://api.kraken.com/0/")){
-            if(resp.hasOwnProperty("error") && resp.error.length > 0 || !resp.hasOwnProperty("result")){
-                appWindow.fiatApiError("Kraken API has error(s)");
-                return;
-            }
-
-            var key = currency === "xmreur" ? "XXMRZEUR" : "XXMRZUSD";
-            var ticker = resp.result[key]["c"][0];
-            return ticker;
-        } else if(url.startsWith("https://api.coingecko.com/api/v3/")){
-            var key = currency === "xmreur" ? "eur" : "usd";
-            if(!resp.hasOwnProperty("monero") || !resp["monero"].hasOwnProperty(key)){
-                appWindow.fiatApiError("Coingecko API has error(s)");
-                return;
-            }
-            return resp["monero"][key];
-        } else if(url.startsWith("https://min-api.cryptocompare.com/data/")){
-            var key = currency === "xmreur" ? "EUR" : "USD";
-            if(!resp.hasOwnProperty(key)){
-                appWindow.fiatApiError("cryptocompare API has error(s)");
-                return;
-            }
-            return resp[key];
-        }
-    }
-
-    function fiatApiGetCurrency(url) {
-        var apis = appWindow.fiatPriceAPIs;
-        for (var api in apis){
-            if (!apis.hasOwnProperty(api))
-               continue;
-
-            for (var cur in apis[api]){
-                if(!apis[api].hasOwnProperty(cur))
-                    continue;
-
-                if (apis[api][cur] === url) {
-                    return cur;
-                }
-            }
-        }
-    }
-
-    function fiatApiJsonReceived(url, resp, error) {
-        if (error) {
-            appWindow.fiatApiError(error);
-            return;
-        }
-
-        try {
-            resp = JSON.parse(resp);
-        } catch (e) {
-            appWindow.fiatApiError("bad JSON: " + e);
-            return;
-        }
-
-        // handle incoming JSON, set ticker
-        var currency = appWindow.fiatApiGetCurrency(url);
-        if(typeof currency == "undefined"){
-            appWindow.fiatApiError("could not get currency");
-            return;
-        }
-
-        var ticker = appWindow.fiatApiParseTicker(url, resp, currency);
-        if(ticker <= 0){
-            appWindow.fiatApiError("could not get ticker");
-            return;
-        }
-
-        appWindow.fiatPrice = ticker;
-
-        appWindow.updateBalance();
-    }
-
-    function fiatApiRefresh(){
-        // trigger API call
-        if(!persistentSettings.fiatPriceEnabled)
-            return;
-
-        var userProvider = persistentSettings.fiatPriceProvider;
-        if(!appWindow.fiatPriceAPIs.hasOwnProperty(userProvider)){
-            appWindow.fiatApiError("provider \"" + userProvider + "\" not implemented");
-            return;
-        }
-
-        var provider = appWindow.fiatPriceAPIs[userProvider];
-        var userCurrency = persistentSettings.fiatPriceCurrency;
-        if(!provider.hasOwnProperty(userCurrency)){
-            appWindow.fiatApiError("currency \"" + userCurrency + "\" not implemented");
-        }
-
-        var url = provider[userCurrency];
-        network.getJSON(url, fiatApiJsonReceived);
-    }
-
     function fiatApiCurrencySymbol() {
         switch (persistentSettings.fiatPriceCurrency) {
             case "xmrusd":
@@ -1415,6 +1288,7 @@ ApplicationWindow {
         property string blockchainDataDir: ""
         property bool useRemoteNode: isAndroid
         property string remoteNodeAddress: "" // TODO: drop after v0.17.2.0 release
+        property bool remoteNodeFailover: false
         property string remoteNodesSerialized: JSON.stringify({
                 selected: 0,
                 nodes: remoteNodeAddress != ""
@@ -1507,7 +1381,9 @@ ApplicationWindow {
                     selected: selected,
                     nodes: remoteNodes
                 });
+                remoteNodeHealth.setNodes(remoteNodes);
             });
+            store();
         }
 
         function appendIfNotExists(newRemoteNode) {
@@ -1581,6 +1457,11 @@ ApplicationWindow {
         // dynamically change onclose handler
         id: txConfirmationPopup
         z: parent.z + 1
+        onRejected: {
+            if (currentWallet) {
+                currentWallet.cancelCreateTransaction();
+            }
+        }
         onAccepted: {
             var handleAccepted = function() {
                 // Save transaction to file if view only wallet
@@ -2246,7 +2127,21 @@ ApplicationWindow {
         appWindow.userLastActive = Utils.epoch();
     }
 
+    function updateChainNotifications() {
+        if (!currentWallet) return;
+        // only a local node publishes its chain events to us, remote nodes keep being polled
+        currentWallet.chainNotificationAddress = persistentSettings.useRemoteNode || typeof daemonManager == "undefined"
+            ? "" : daemonManager.zmqPubAddress(persistentSettings.nettype);
+    }
+
+    function updateRefreshActivity() {
+        if (!currentWallet) return;
+        var windowVisible = appWindow.visibility !== Window.Minimized && appWindow.visibility !== Window.Hidden;
+        currentWallet.setUserActivity(windowVisible, Utils.epoch() - appWindow.userLastActive);
+    }
+
     function checkInUserActivity() {
+        updateRefreshActivity();
         if(rootItem.state !== "normal") return;
         if(!persistentSettings.lockOnUserInActivity) return;
         if(passwordDialog.visible) return;
@@ -2402,9 +2297,31 @@ ApplicationWindow {
 
     MoneroComponents.MenuBar { }
 
-    Network {
-        id: network
+    PriceFeed {
+        id: priceFeed
+        proxyAddress: persistentSettings.getProxyAddress()
+        currency: persistentSettings.fiatPriceCurrency
+        provider: persistentSettings.fiatPriceProvider
+        active: persistentSettings.fiatPriceEnabled && currentWallet !== undefined
+        onPriceChanged: appWindow.updateBalance()
+        onErrorChanged: {
+            if (error) {
+                appWindow.fiatApiError(error);
+            }
+        }
+    }
+
+    RemoteNodeHealth {
+        id: remoteNodeHealth
         proxyAddress: persistentSettings.getProxyAddress()
+        nettype: persistentSettings.nettype
+        active: persistentSettings.useRemoteNode && currentWallet !== undefined && currentWallet !== null
+        failoverEnabled: persistentSettings.remoteNodeFailover
+        current: persistentSettings.useRemoteNode ? remoteNodesModel.selected : -1
+        onFailover: {
+            console.log("Remote node failover to " + remoteNodesModel.get(index).address + ": " + reason);
+            remoteNodesModel.applyRemoteNode(index);
+        }
     }
 
     WalletManager {
@@ -56,8 +56,6 @@ Rectangle {
     property var sortSearchString: null
     property bool sortDirection: true  // true = desc, false = asc
     property string sortBy: "blockheight"
-    property var txModelData: []  // representation of transaction data (appWindow.currentWallet.historyModel)
-    property var txData: []  // representation of FILTERED transation data
     property var txDataCollapsed: []  // keep track of which txs are collapsed
     property string historyStatusMessage: ""
     property alias contentHeight: pageRoot.height
@@ -1407,16 +1405,13 @@ Rectangle {
 
     function refresh(){
         if(appWindow.currentWallet != null && typeof appWindow.currentWallet.history !== "undefined" ) {
-            currentWallet.history.refresh(currentWallet.currentSubaddressAccount);
+            currentWallet.history.refreshAsync(currentWallet.currentSubaddressAccount);
         }
 
         if (typeof root.model !== 'undefined' && root.model != null) {
             toDatePicker.currentDate = root.model.transactionHistory.lastDateTime
         }
 
-        // extract from model, create JS array of txs
-        root.updateTransactionsFromModel();
-
         // fill listview, update UI
         root.updateDisplay(root.txOffset, root.txMax);
     }
@@ -1437,92 +1432,59 @@ Rectangle {
     }
 
     function updateFilter(currentPage){
-        // applying filters
-        root.txData = JSON.parse(JSON.stringify(root.txModelData)); // deepcopy
-
-        const timezoneOffset = new Date().getTimezoneOffset() * 60;
-        var fromDate = Math.floor(fromDatePicker.currentDate.getTime() / 86400000) * 86400 + timezoneOffset;
-        var toDate = (Math.floor(toDatePicker.currentDate.getTime() / 86400000) + 1) * 86400 + timezoneOffset;
-
-        var txs = [];
-        for (var i = 0; i < root.txData.length; i++){
-            var item = root.txData[i];
-            var matched = "";
-
-            // daterange filtering
-            if(item.timestamp < fromDate || item.timestamp > toDate){
-                continue;
-            }
-
-            // search string filtering
-            if(root.sortSearchString == null || root.sortSearchString === ""){
-                txs.push(root.txData[i]);
-                continue;
-            }
-
-            if(root.sortSearchString.length >= 1){
-                if(item.amount && item.amount.toString().startsWith(root.sortSearchString)){
-                    txs.push(item);
-                } else if(item.address !== "" && item.address.toLowerCase().startsWith(root.sortSearchString.toLowerCase())){
-                    txs.push(item);
-                } else if(item.receivingAddress !== "" && item.receivingAddress.toLowerCase().startsWith(root.sortSearchString.toLowerCase())){
-                    txs.push(item);
-                } else if(item.receivingAddressLabel !== "" && item.receivingAddressLabel.toLowerCase().startsWith(root.sortSearchString.toLowerCase())){
-                    txs.push(item);
-                } else if(item.addressBookName !== "" && item.addressBookName.toLowerCase().startsWith(root.sortSearchString.toLowerCase())){
-                    txs.push(item);
-                } else if(typeof item.blockheight !== "undefined" && item.blockheight.toString().startsWith(root.sortSearchString)) {
-                    txs.push(item);
-                } else if(item.tx_note.toLowerCase().indexOf(root.sortSearchString.toLowerCase()) !== -1) {
-                    txs.push(item);
-                } else if (item.hash.startsWith(root.sortSearchString)){
-                    txs.push(item);
-                }
-            }
-        }
-
-        root.txData = txs;
-        root.txCount = root.txData.length;
-
+        // filters are applied by the native query in updateDisplay()
         root.updateSort();
-        root.updateDisplay(root.txOffset, root.txMax);
         if (currentPage) {
             root.paginationJump(parseInt(currentPage));
         }
     }
 
     function updateSort(){
-        // applying sorts
+        // sorting is applied by the native query in updateDisplay()
         root.txOffset = 0;
-        root.txData.sort(function(a, b) {
-            return a[root.sortBy] - b[root.sortBy];
-        });
-
-        if(root.sortDirection)
-            root.txData.reverse();
-
         root.updateDisplay(root.txOffset, root.txMax);
     }
 
+    function querySortRole(){
+        if (root.sortBy === "timestamp")
+            return TransactionHistoryModel.TransactionTimeStampRole;
+        if (root.sortBy === "amount")
+            return TransactionHistoryModel.TransactionAmountRole;
+        return TransactionHistoryModel.TransactionBlockHeightRole;
+    }
+
     function updateDisplay(tx_offset, tx_max) {
         txListViewModel.clear();
 
-        // limit results as per tx_max (root.txMax)
-        var txs = root.txData.slice(tx_offset, tx_offset + tx_max);
+        if (typeof root.model === 'undefined' || root.model == null) {
+            root.txCount = 0;
+            root.updateHistoryStatusMessage();
+            return;
+        }
+
+        // only the visible page leaves the model
+        var filter = {
+            "search": root.sortSearchString != null ? root.sortSearchString : "",
+            "dateFrom": fromDatePicker.currentDate,
+            "dateTo": toDatePicker.currentDate
+        };
+        var result = root.model.queryPage(filter, root.querySortRole(), root.sortDirection, Math.floor(tx_offset / tx_max), tx_max);
+        root.txCount = result.total;
+        var txs = result.rows;
 
         // collapse tx if there is a single result
         if(root.txPage === 1 && txs.length === 1)
-            root.txDataCollapsed.push(txs[0]['hash']);
+            root.txDataCollapsed.push(txs[0].hash);
 
         // populate listview
         for (var i = 0; i < txs.length; i++){
-            txListViewModel.append(txs[i]);
+            txListViewModel.append(root.transactionFromRow(txs[i]));
         }
 
         root.updateHistoryStatusMessage();
 
         // determine pagination button states
-        var count = txData.length;
+        var count = root.txCount;
         if(count <= root.txMax) {
             paginationPrev.enabled = false;
             paginationNext.enabled = false;
@@ -1540,98 +1502,62 @@ Rectangle {
             paginationNext.enabled = true;
     }
 
-    function updateTransactionsFromModel() {
-        // This function copies the items of `appWindow.currentWallet.historyModel` to `root.txModelData`, as a list of javascript objects
-        if(currentWallet == null || typeof currentWallet.history === "undefined" ) return;
-
-        var _model = root.model;
-        var total = 0
-        var count = _model.rowCount()
-        root.txModelData = [];
-
-        for (var i = 0; i < count; ++i) {
-            var idx = _model.index(i, 0);
-            var isPending = model.data(idx, TransactionHistoryModel.TransactionPendingRole);
-            var isFailed = model.data(idx, TransactionHistoryModel.TransactionFailedRole);
-            var isout = _model.data(idx, TransactionHistoryModel.TransactionIsOutRole);
-            var amount = _model.data(idx, TransactionHistoryModel.TransactionAmountRole);
-            var hash = _model.data(idx, TransactionHistoryModel.TransactionHashRole);
-            var paymentId = _model.data(idx, TransactionHistoryModel.TransactionPaymentIdRole);
-            var destinations = _model.data(idx, TransactionHistoryModel.TransactionDestinationsRole);
-            var time = _model.data(idx, TransactionHistoryModel.TransactionTimeRole);
-            var date = _model.data(idx, TransactionHistoryModel.TransactionDateRole);
-            var blockheight = _model.data(idx, TransactionHistoryModel.TransactionBlockHeightRole);
-            var confirmations = _model.data(idx, TransactionHistoryModel.TransactionConfirmationsRole);
-            var confirmationsRequired = _model.data(idx, TransactionHistoryModel.TransactionConfirmationsRequiredRole);
-            var fee = _model.data(idx, TransactionHistoryModel.TransactionFeeRole);
-            var subaddrAccount = model.data(idx, TransactionHistoryModel.TransactionSubaddrAccountRole);
-            var subaddrIndex = model.data(idx, TransactionHistoryModel.TransactionSubaddrIndexRole);
-            var timestamp = new Date(date + " " + time).getTime() / 1000;
-            var dateHuman = Utils.ago(timestamp);
-
-            if (amount === 0) {
-                // transactions to the same account have amount === 0, while the 'destinations string'
-                // has the correct amount, so we try to fetch it from that instead.
-                amount = Number(TxUtils.destinationsToAmount(destinations));
-            }
-            var displayAmount = Utils.removeTrailingZeros(amount.toFixed(12)) + " XMR";
+    function transactionFromRow(tx) {
+        // This function turns a row returned by `historyModel.queryPage` into the listview representation
+        var amount = tx.amount;
+        if (amount === 0) {
+            // transactions to the same account have amount === 0, while the 'destinations string'
+            // has the correct amount, so we try to fetch it from that instead.
+            amount = Number(TxUtils.destinationsToAmount(tx.destinations));
+        }
+        var displayAmount = Utils.removeTrailingZeros(amount.toFixed(12)) + " XMR";
+        var timestamp = tx.timeStamp.getTime() / 1000;
 
-            var tx_note = currentWallet.getUserNote(hash);
-            var address = "";
-            var addressBookName = "";
-            var receivingAddress = "";
-            var receivingAddressLabel = "";
+        var address = "";
+        var addressBookName = "";
+        var receivingAddress = "";
+        var receivingAddressLabel = "";
 
-            if (isout) {
-                address = TxUtils.destinationsToAddress(destinations);
-                addressBookName = currentWallet ? currentWallet.addressBook.getDescription(address) : null;
-            } else {
-                receivingAddress = currentWallet ? currentWallet.address(subaddrAccount, subaddrIndex) : null;
-                receivingAddressLabel = currentWallet ? appWindow.currentWallet.getSubaddressLabel(subaddrAccount, subaddrIndex) : null;
-            }
-
-            if (isout)
-                total = walletManager.subi(total, amount)
-            else
-                total = walletManager.addi(total, amount)
-
-            root.txModelData.push({
-                "i": i,
-                "isPending": isPending,
-                "isFailed": isFailed,
-                "isout": isout,
-                "amount": amount,
-                "displayAmount": displayAmount,
-                "hash": hash,
-                "paymentId": paymentId,
-                "address": address,
-                "addressBookName": addressBookName,
-                "destinations": destinations,
-                "tx_note": tx_note,
-                "dateHuman": dateHuman,
-                "dateTime": date + " " + time,
-                "blockheight": blockheight,
-                "address": address,
-                "timestamp": timestamp,
-                "fee": fee,
-                "confirmations": confirmations,
-                "confirmationsRequired": confirmationsRequired,
-                "receivingAddress": receivingAddress,
-                "receivingAddressLabel": receivingAddressLabel,
-                "subaddrAccount": subaddrAccount,
-                "subaddrIndex": subaddrIndex
-            });
+        if (tx.isOut) {
+            address = TxUtils.destinationsToAddress(tx.destinations);
+            addressBookName = currentWallet ? currentWallet.addressBook.getDescription(address) : null;
+        } else {
+            receivingAddress = currentWallet ? currentWallet.address(tx.subaddrAccount, tx.subaddrIndex) : null;
+            receivingAddressLabel = currentWallet ? appWindow.currentWallet.getSubaddressLabel(tx.subaddrAccount, tx.subaddrIndex) : null;
         }
 
-        root.txData = JSON.parse(JSON.stringify(root.txModelData)); // deepcopy
-        root.txCount = root.txData.length;
+        return {
+            "i": tx.row,
+            "isPending": tx.isPending,
+            "isFailed": tx.isFailed,
+            "isout": tx.isOut,
+            "amount": amount,
+            "displayAmount": displayAmount,
+            "hash": tx.hash,
+            "paymentId": tx.paymentId,
+            "address": address,
+            "addressBookName": addressBookName,
+            "destinations": tx.destinations,
+            "tx_note": currentWallet.getUserNote(tx.hash),
+            "dateHuman": Utils.ago(timestamp),
+            "dateTime": tx.date + " " + tx.time,
+            "blockheight": tx.blockHeight,
+            "timestamp": timestamp,
+            "fee": tx.fee,
+            "confirmations": tx.confirmations,
+            "confirmationsRequired": tx.confirmationsRequired,
+            "receivingAddress": receivingAddress,
+            "receivingAddressLabel": receivingAddressLabel,
+            "subaddrAccount": tx.subaddrAccount,
+            "subaddrIndex": tx.subaddrIndex
+        };
     }
 
     function update(currentPage) {
         // handle outside mutation of tx model; incoming/outgoing funds or new blocks. Update table.
-        currentWallet.history.refresh(currentWallet.currentSubaddressAccount);
+        // The table is queried again once the refresh lands, see onRefreshed.
+        currentWallet.history.refreshAsync(currentWallet.currentSubaddressAccount);
 
-        root.updateTransactionsFromModel();
         root.updateFilter(currentPage);
     }
 
@@ -1668,12 +1594,12 @@ Rectangle {
     }
 
     function updateHistoryStatusMessage(){
-        if(root.txModelData.length <= 0){
+        if(root.model == null || root.model.transactionHistory.count <= 0){
             root.historyStatusMessage = qsTr("No transaction history yet.") + translationManager.emptyString;
-        } else if (root.txData.length <= 0){
+        } else if (root.txCount <= 0){
             root.historyStatusMessage = qsTr("No results.") + translationManager.emptyString;
         } else {
-            root.historyStatusMessage = qsTr("%1 transactions total, showing %2.").arg(root.txData.length).arg(txListViewModel.count) + translationManager.emptyString;
+            root.historyStatusMessage = qsTr("%1 transactions total, showing %2.").arg(root.txCount).arg(txListViewModel.count) + translationManager.emptyString;
         }
     }
 
@@ -1753,27 +1679,37 @@ Rectangle {
             + translationManager.emptyString;
     }
 
-    FileDialog {
-        id: writeCSVFileDialog
-        title: qsTr("Please choose a folder") + translationManager.emptyString
-        selectFolder: true
-        onRejected: {
-            console.log("csv write canceled")
+    Connections {
+        target: root.model ? root.model : null
+        function onSearchIndexReady() {
+            if (root.initialized && root.sortSearchString) {
+                root.updateDisplay(root.txOffset, root.txMax);
+            }
         }
-        onAccepted: {
-            var dataDir = walletManager.urlToLocalPath(writeCSVFileDialog.fileUrl);
-            var written = currentWallet.history.writeCSV(currentWallet.currentSubaddressAccount, dataDir);
+    }
+
+    Connections {
+        target: currentWallet ? currentWallet.history : null
+        function onRefreshed() {
+            if (root.initialized) {
+                root.updateDisplay(root.txOffset, root.txMax);
+            }
+        }
+        function onExportFinished(path, cancelled) {
+            if (cancelled) {
+                return;
+            }
 
-            if(written !== ""){
+            if(path !== ""){
                 confirmationDialog.title = qsTr("Success") + translationManager.emptyString;
-                var text = qsTr("CSV file written to: %1").arg(written) + "\n\n"
+                var text = qsTr("CSV file written to: %1").arg(path) + "\n\n"
                 text += qsTr("Tip: Use your favorite spreadsheet software to sort on blockheight.") + "\n\n" + translationManager.emptyString;
                 confirmationDialog.text = text;
                 confirmationDialog.icon = StandardIcon.Information;
                 confirmationDialog.cancelText = qsTr("Open folder") + translationManager.emptyString;
                 confirmationDialog.onAcceptedCallback = null;
                 confirmationDialog.onRejectedCallback = function() {
-                    oshelper.openContainingFolder(written);
+                    oshelper.openContainingFolder(path);
                 }
                 confirmationDialog.open();
             } else {
@@ -1782,8 +1718,24 @@ Rectangle {
                 informationPopup.icon = StandardIcon.Critical;
                 informationPopup.onCloseCallback = null;
                 informationPopup.open();
+            }
+        }
+    }
 
+    FileDialog {
+        id: writeCSVFileDialog
+        title: qsTr("Please choose a folder") + translationManager.emptyString
+        selectFolder: true
+        onRejected: {
+            console.log("csv write canceled")
+        }
+        onAccepted: {
+            var dataDir = walletManager.urlToLocalPath(writeCSVFileDialog.fileUrl);
+            if (!currentWallet.history.exportAsync(currentWallet.currentSubaddressAccount, dataDir, TransactionHistory.ExportFormat_CSV)) {
+                appWindow.showStatusMessage(qsTr("An export is already running.") + translationManager.emptyString, 3);
+                return;
             }
+            appWindow.showStatusMessage(qsTr("Exporting transaction data...") + translationManager.emptyString, 3);
         }
         Component.onCompleted: {
             var _folder = 'file://' + appWindow.accountsDir;
@@ -1801,16 +1753,8 @@ Rectangle {
         // setup date filter scope according to real transactions
         if(appWindow.currentWallet != null){
             root.model = appWindow.currentWallet.historyModel;
-            root.model.sortRole = TransactionHistoryModel.TransactionBlockHeightRole
-            root.model.sort(0, Qt.DescendingOrder);
-            var count = root.model.rowCount()
-            if (count > 0) {
-                //date of the first transaction
-                fromDatePicker.currentDate = root.model.data(root.model.index((count - 1), 0), TransactionHistoryModel.TransactionDateRole);
-            } else {
-                //date of monero birth (2014-04-18)
-                fromDatePicker.currentDate = model.transactionHistory.firstDateTime
-            }
+            //date of the first transaction, or of monero birth (2014-04-18) without any
+            fromDatePicker.currentDate = root.model.transactionHistory.firstDateTime
         }
 
         root.reset();
@@ -192,9 +192,6 @@ Rectangle {
                 onChanged: {
                     var obj = dataModel.get(currentIndex);
                     persistentSettings.fiatPriceProvider = obj.data;
-
-                    if(persistentSettings.fiatPriceEnabled)
-                        appWindow.fiatApiRefresh();
                 }
             }
 
@@ -208,9 +205,6 @@ Rectangle {
                 onChanged: {
                     var obj = dataModel.get(currentIndex);
                     persistentSettings.fiatPriceCurrency = obj.data;
-
-                    if(persistentSettings.fiatPriceEnabled)
-                        appWindow.fiatApiRefresh();
                 }
             }
 
@@ -225,7 +219,7 @@ Rectangle {
             Layout.leftMargin: 36
 
             MoneroComponents.WarningBox {
-                text: qsTr("Enabling price conversion exposes your IP address to the selected price source.") + translationManager.emptyString;
+                text: qsTr("Enabling price conversion exposes your IP address to the selected price source, or to all of them for the median.") + translationManager.emptyString;
             }
 
             MoneroComponents.StandardButton {
@@ -301,20 +295,17 @@ Rectangle {
     }
 
     Component.onCompleted: {
-        // Dynamically fill fiatPrice dropdown based on `appWindow.fiatPriceAPIs`
-        var apis = appWindow.fiatPriceAPIs;
+        // Dynamically fill fiatPrice dropdown based on the sources `priceFeed` implements
+        var apis = priceFeed.providers();
         fiatPriceProvidersModel.clear();
 
-        var i = 0;
-        for (var api in apis){
-            if (!apis.hasOwnProperty(api))
-               continue;
-
-            fiatPriceProvidersModel.append({"column1": Utils.capitalize(api), "data": api});
+        for (var i = 0; i < apis.length; ++i) {
+            var api = apis[i];
+            var label = api === "median" ? qsTr("Median of all") + translationManager.emptyString : Utils.capitalize(api);
+            fiatPriceProvidersModel.append({"column1": label, "data": api});
 
             if(api === persistentSettings.fiatPriceProvider)
                 fiatPriceProviderDropDown.currentIndex = i;
-            i += 1;
         }
 
         console.log('SettingsLayout loaded');
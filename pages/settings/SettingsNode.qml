@@ -261,6 +261,14 @@ Rectangle{
             visible: persistentSettings.useRemoteNode
         }
 
+        MoneroComponents.CheckBox {
+            Layout.topMargin: 20
+            visible: persistentSettings.useRemoteNode
+            checked: persistentSettings.remoteNodeFailover
+            onClicked: persistentSettings.remoteNodeFailover = !persistentSettings.remoteNodeFailover
+            text: qsTr("Switch to the best responding node when the selected one fails or falls behind") + translationManager.emptyString
+        }
+
         ColumnLayout {
             id: localNodeLayout
             spacing: 20
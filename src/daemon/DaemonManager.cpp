@@ -46,6 +46,34 @@
 
 namespace {
     static const int DAEMON_START_TIMEOUT_SECONDS = 120;
+
+    // the endpoint set by the user's --zmq-pub flag, or an empty one if --no-zmq turns zmq off;
+    // false if the flags leave the publisher to us
+    bool zmqPubFromFlags(const QString &flags, QString &endpoint)
+    {
+        QStringList args = flags.split(" ");
+        args.removeAll(QString());
+        if (args.contains("--no-zmq")) {
+            endpoint.clear();
+            return true;
+        }
+        for (int i = 0; i < args.size(); ++i) {
+            QString value;
+            if (args[i] == "--zmq-pub" && i + 1 < args.size()) {
+                value = args[i + 1];
+            } else if (args[i].startsWith("--zmq-pub=")) {
+                value = args[i].mid(QString("--zmq-pub=").size());
+            } else {
+                continue;
+            }
+            // a wildcard bind is reached through loopback
+            value.replace("://0.0.0.0:", "://127.0.0.1:");
+            value.replace("://*:", "://127.0.0.1:");
+            endpoint = value;
+            return true;
+        }
+        return false;
+    }
 }
 
 bool DaemonManager::start(const QString &flags, NetworkType::Type nettype, const QString &dataDir, const QString &bootstrapNodeAddress, bool noSync /* = false*/, bool pruneBlockchain /* = false*/)
@@ -106,6 +134,13 @@ bool DaemonManager::start(const QString &flags, NetworkType::Type nettype, const
         arguments << "--max-concurrency" << QString::number(concurrency);
     }
 
+    // chain events let the wallet refresh as soon as a block arrives instead of polling for it
+    QString zmqPub;
+    if (!zmqPubFromFlags(flags, zmqPub)) {
+        arguments << "--zmq-pub" << defaultZmqPubAddress(nettype);
+    }
+    m_startFlags = flags;
+
     qDebug() << "starting monerod " + m_monerod;
     qDebug() << "With command line arguments " << arguments;
 
@@ -137,7 +172,7 @@ bool DaemonManager::start(const QString &flags, NetworkType::Type nettype, const
         } else {
             emit daemonStartFailure(tr("Timed out, local node is not responding after %1 seconds").arg(DAEMON_START_TIMEOUT_SECONDS));
         }
-    });
+    }, FutureScheduler::Lane::Dedicated, FutureScheduler::Priority_Normal, "startWatcher");
 
     return true;
 }
@@ -149,7 +184,7 @@ void DaemonManager::stopAsync(NetworkType::Type nettype, const QString &dataDir,
         sendCommand({"exit"}, nettype, dataDir, message);
 
         return QJSValueList({stopWatcher(nettype, dataDir)});
-    }, callback);
+    }, callback, FutureScheduler::Lane::Dedicated, FutureScheduler::Priority_Normal, "stopWatcher");
 
     if (!feature.first)
     {
@@ -253,7 +288,7 @@ void DaemonManager::runningAsync(NetworkType::Type nettype, const QString &dataD
 { 
     m_scheduler.run([this, nettype, dataDir] {
         return QJSValueList({running(nettype, dataDir)});
-    }, callback);
+    }, callback, FutureScheduler::Lane::Background);
 }
 
 bool DaemonManager::sendCommand(const QStringList &cmd, NetworkType::Type nettype, const QString &dataDir, QString &message) const
@@ -288,7 +323,7 @@ void DaemonManager::sendCommandAsync(const QStringList &cmd, NetworkType::Type n
     m_scheduler.run([this, cmd, nettype, dataDir] {
         QString message;
         return QJSValueList({sendCommand(cmd, nettype, dataDir, message)});
-    }, callback);
+    }, callback, FutureScheduler::Lane::Background);
 }
 
 void DaemonManager::exit()
@@ -393,6 +428,26 @@ QString DaemonManager::getArgs(const QString &dataDir) {
     return args;
 }
 
+QString DaemonManager::zmqPubAddress(NetworkType::Type nettype) const
+{
+    QString endpoint;
+    if (zmqPubFromFlags(m_startFlags, endpoint)) {
+        return endpoint;
+    }
+    return defaultZmqPubAddress(nettype);
+}
+
+QString DaemonManager::defaultZmqPubAddress(NetworkType::Type nettype)
+{
+    // next to the default zmq rpc port of each network, on mainnet the port p2pool expects
+    int port = 18083;
+    if (nettype == NetworkType::TESTNET)
+        port = 28083;
+    else if (nettype == NetworkType::STAGENET)
+        port = 38083;
+    return QString("tcp://127.0.0.1:%1").arg(port);
+}
+
 DaemonManager::DaemonManager(QObject *parent)
     : QObject(parent)
     , m_scheduler(this)
@@ -59,9 +59,13 @@ public:
     Q_INVOKABLE QVariantMap validateDataDir(const QString &dataDir) const;
     Q_INVOKABLE bool checkLmdbExists(QString datadir);
     Q_INVOKABLE QString getArgs(const QString &dataDir);
+    //! endpoint the started daemon publishes its chain events on, as set by its flags;
+    //! empty if they turn zmq off
+    Q_INVOKABLE QString zmqPubAddress(NetworkType::Type nettype) const;
 
 private:
 
+    static QString defaultZmqPubAddress(NetworkType::Type nettype);
     bool running(NetworkType::Type nettype, const QString &dataDir) const;
     bool sendCommand(const QStringList &cmd, NetworkType::Type nettype, const QString &dataDir, QString &message) const;
     bool startWatcher(NetworkType::Type nettype, const QString &dataDir) const;
@@ -83,6 +87,8 @@ private:
     QString m_monerod;
     bool m_app_exit = false;
     bool m_noSync = false;
+    // flags of the last start, they may override the chain events endpoint
+    QString m_startFlags;
     QString args = "";
 
     mutable FutureScheduler m_scheduler;
@@ -30,7 +30,7 @@
 #include <QDebug>
 
 AddressBook::AddressBook(Monero::AddressBook *abImpl,QObject *parent)
-  : QObject(parent), m_addressBookImpl(abImpl)
+  : QObject(parent), m_addressBookImpl(abImpl), m_snapshot(std::make_shared<const Snapshot>())
 {
     getAll();
 }
@@ -47,32 +47,32 @@ int AddressBook::errorCode() const
 
 void AddressBook::getAll()
 {
-    emit refreshStarted();
-
+    // the backend owns its rows only until its next refresh, the snapshot keeps copies
+    auto snapshot = std::make_shared<Snapshot>();
     {
-        QWriteLocker locker(&m_lock);
+        QMutexLocker locker(&m_implMutex);
 
-        m_addresses.clear();
-        m_rows.clear();
-        for (auto &abr: m_addressBookImpl->getAll()) {
-            m_addresses.insert(QString::fromStdString(abr->getAddress()), m_rows.size());
-            m_rows.append(abr);
+        for (const auto &abr: m_addressBookImpl->getAll()) {
+            snapshot->addresses.insert(QString::fromStdString(abr->getAddress()), snapshot->rows.size());
+            snapshot->rows.push_back(*abr);
         }
     }
 
+    emit refreshStarted();
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(std::move(snapshot)));
     emit refreshFinished();
 }
 
-bool AddressBook::getRow(int index, std::function<void (Monero::AddressBookRow &)> callback) const
+bool AddressBook::getRow(int index, std::function<void (const Monero::AddressBookRow &)> callback) const
 {
-    QReadLocker locker(&m_lock);
+    const std::shared_ptr<const Snapshot> current = snapshot();
 
-    if (index < 0 || index >= m_rows.size())
+    if (index < 0 || static_cast<size_t>(index) >= current->rows.size())
     {
         return false;
     }
 
-    callback(*m_rows.value(index));
+    callback(current->rows[index]);
     return true;
 }
 
@@ -82,7 +82,7 @@ bool AddressBook::addRow(const QString &address, const QString &payment_id, cons
     bool result;
 
     {
-        QWriteLocker locker(&m_lock);
+        QMutexLocker locker(&m_implMutex);
 
         result = m_addressBookImpl->addRow(address.toStdString(), payment_id.toStdString(), description.toStdString());
     }
@@ -100,7 +100,7 @@ bool AddressBook::deleteRow(int rowId)
     bool result;
 
     {
-        QWriteLocker locker(&m_lock);
+        QMutexLocker locker(&m_implMutex);
 
         result = m_addressBookImpl->deleteRow(rowId);
     }
@@ -116,21 +116,19 @@ bool AddressBook::deleteRow(int rowId)
 
 quint64 AddressBook::count() const
 {
-    QReadLocker locker(&m_lock);
-
-    return m_rows.size();
+    return snapshot()->rows.size();
 }
 
 QString AddressBook::getDescription(const QString &address) const
 {
-    QReadLocker locker(&m_lock);
+    const std::shared_ptr<const Snapshot> current = snapshot();
 
-    const QMap<QString, size_t>::const_iterator it = m_addresses.find(address);
-    if (it == m_addresses.end())
+    const QMap<QString, size_t>::const_iterator it = current->addresses.find(address);
+    if (it == current->addresses.end())
     {
         return {};
     }
-    return QString::fromStdString(m_rows.value(*it)->getDescription());
+    return QString::fromStdString(current->rows[*it].getDescription());
 }
 
 void AddressBook::setDescription(int index, const QString &description)
@@ -138,7 +136,7 @@ void AddressBook::setDescription(int index, const QString &description)
      bool result;
 
      {
-         QWriteLocker locker(&m_lock);
+         QMutexLocker locker(&m_implMutex);
 
          result = m_addressBookImpl->setDescription(index, description.toStdString());
      }
@@ -148,3 +146,8 @@ void AddressBook::setDescription(int index, const QString &description)
          getAll();
      }
  }
+
+std::shared_ptr<const AddressBook::Snapshot> AddressBook::snapshot() const
+{
+    return std::atomic_load(&m_snapshot);
+}
@@ -29,11 +29,13 @@
 #ifndef ADDRESSBOOK_H
 #define ADDRESSBOOK_H
 
+#include <memory>
+#include <vector>
+
 #include <wallet/api/wallet2_api.h>
 #include <QMap>
 #include <QObject>
-#include <QReadWriteLock>
-#include <QList>
+#include <QMutex>
 #include <QDateTime>
 
 namespace Monero {
@@ -45,7 +47,14 @@ class AddressBook : public QObject
 {
     Q_OBJECT
 public:
-    Q_INVOKABLE bool getRow(int index, std::function<void (Monero::AddressBookRow &)> callback) const;
+    //! copies of the backend rows and their address lookup, never modified once published
+    struct Snapshot
+    {
+        std::vector<Monero::AddressBookRow> rows;
+        QMap<QString, size_t> addresses;
+    };
+
+    Q_INVOKABLE bool getRow(int index, std::function<void (const Monero::AddressBookRow &)> callback) const;
     Q_INVOKABLE bool addRow(const QString &address, const QString &payment_id, const QString &description);
     Q_INVOKABLE bool deleteRow(int rowId);
     quint64 count() const;
@@ -53,6 +62,8 @@ public:
     Q_INVOKABLE int errorCode() const;
     Q_INVOKABLE QString getDescription(const QString &address) const;
     Q_INVOKABLE void setDescription(int index, const QString &label);
+    //! immutable snapshot of the rows, readers on any thread take no lock
+    std::shared_ptr<const Snapshot> snapshot() const;
 
     enum ErrorCode {
         Status_Ok,
@@ -77,9 +88,10 @@ private:
     explicit AddressBook(Monero::AddressBook * abImpl, QObject *parent);
     friend class Wallet;
     Monero::AddressBook * m_addressBookImpl;
-    mutable QReadWriteLock m_lock;
-    QList<Monero::AddressBookRow*> m_rows;
-    QMap<QString, size_t> m_addresses;
+    // serializes the use of the backend, readers only ever load m_snapshot
+    QMutex m_implMutex;
+    // swapped atomically
+    std::shared_ptr<const Snapshot> m_snapshot;
 };
 
 #endif // ADDRESSBOOK_H
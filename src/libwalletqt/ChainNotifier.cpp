@@ -0,0 +1,214 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "ChainNotifier.h"
+
+#include <chrono>
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+
+#include <zmq.h>
+
+namespace
+{
+constexpr const char chainTopic[] = "json-minimal-chain_main";
+constexpr const char txPoolTopic[] = "json-minimal-txpool_add";
+// bounds how long stopping the notifier can take
+constexpr const int pollTimeoutMs = 250;
+// blocks come every two minutes, missing several in a row means the publisher is gone
+constexpr const std::chrono::minutes liveWindow{10};
+
+qint64 steadyNowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+ChainNotifier::ChainNotifier(QObject *parent)
+    : QObject(parent)
+    , m_stopping(false)
+    , m_lastNotification(0)
+{
+}
+
+ChainNotifier::~ChainNotifier()
+{
+    stop();
+}
+
+void ChainNotifier::setAddress(const QString &address)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_address == address)
+        {
+            return;
+        }
+        m_address = address;
+    }
+
+    stop();
+    m_lastNotification = 0;
+    if (!address.isEmpty())
+    {
+        start(address);
+    }
+}
+
+QString ChainNotifier::address() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_address;
+}
+
+bool ChainNotifier::live() const
+{
+    const qint64 last = m_lastNotification;
+    return last != 0 && steadyNowMs() - last < std::chrono::duration_cast<std::chrono::milliseconds>(liveWindow).count();
+}
+
+void ChainNotifier::start(const QString &address)
+{
+    m_stopping = false;
+    m_thread = std::thread([this, address] {
+        run(address);
+    });
+}
+
+void ChainNotifier::stop()
+{
+    m_stopping = true;
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void ChainNotifier::run(const QString &address)
+{
+    void *context = zmq_ctx_new();
+    void *socket = zmq_socket(context, ZMQ_SUB);
+    const int linger = 0;
+    zmq_setsockopt(socket, ZMQ_LINGER, &linger, sizeof(linger));
+    zmq_setsockopt(socket, ZMQ_SUBSCRIBE, chainTopic, sizeof(chainTopic) - 1);
+    zmq_setsockopt(socket, ZMQ_SUBSCRIBE, txPoolTopic, sizeof(txPoolTopic) - 1);
+
+    // connecting succeeds without a publisher, zmq keeps reconnecting in the background
+    if (zmq_connect(socket, address.toUtf8().constData()) != 0)
+    {
+        qWarning() << "Failed to subscribe to chain notifications at" << address << zmq_strerror(zmq_errno());
+        m_stopping = true;
+    }
+    else
+    {
+        qDebug() << "Subscribed to chain notifications at" << address;
+    }
+
+    while (!m_stopping)
+    {
+        zmq_pollitem_t item{socket, 0, ZMQ_POLLIN, 0};
+        if (zmq_poll(&item, 1, pollTimeoutMs) < 0)
+        {
+            if (zmq_errno() == EINTR)
+            {
+                continue;
+            }
+            qWarning() << "Chain notifications stopped:" << zmq_strerror(zmq_errno());
+            break;
+        }
+        if (!(item.revents & ZMQ_POLLIN))
+        {
+            continue;
+        }
+
+        // the daemon sends single frame messages, any further frames are drained and ignored
+        bool first = true;
+        int more = 0;
+        size_t moreSize = sizeof(more);
+        do
+        {
+            zmq_msg_t message;
+            zmq_msg_init(&message);
+            if (zmq_msg_recv(&message, socket, ZMQ_DONTWAIT) < 0)
+            {
+                zmq_msg_close(&message);
+                break;
+            }
+            if (first)
+            {
+                handle(QByteArray(static_cast<const char *>(zmq_msg_data(&message)), static_cast<int>(zmq_msg_size(&message))));
+                first = false;
+            }
+            zmq_msg_close(&message);
+            zmq_getsockopt(socket, ZMQ_RCVMORE, &more, &moreSize);
+        } while (more);
+    }
+
+    zmq_close(socket);
+    zmq_ctx_term(context);
+}
+
+void ChainNotifier::handle(const QByteArray &message)
+{
+    const int separator = message.indexOf(':');
+    if (separator < 0)
+    {
+        return;
+    }
+    const QByteArray topic = message.left(separator);
+    const QJsonDocument document = QJsonDocument::fromJson(message.mid(separator + 1));
+
+    if (topic == chainTopic)
+    {
+        // {"first_height": ..., "first_prev_id": ..., "ids": [...]}, first_height is the first new block's index
+        const QJsonObject chain = document.object();
+        const QJsonArray ids = chain.value("ids").toArray();
+        if (!chain.contains("first_height") || ids.isEmpty())
+        {
+            qWarning() << "Malformed chain notification";
+            return;
+        }
+        m_lastNotification = steadyNowMs();
+        emit newBlock(static_cast<quint64>(chain.value("first_height").toDouble()) + ids.size());
+    }
+    else if (topic == txPoolTopic)
+    {
+        // [{"id": ..., "blob_size": ..., "weight": ..., "fee": ...}, ...]
+        if (!document.isArray())
+        {
+            qWarning() << "Malformed txpool notification";
+            return;
+        }
+        m_lastNotification = steadyNowMs();
+        emit txPoolAdded(document.array().size());
+    }
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CHAINNOTIFIER_H
+#define CHAINNOTIFIER_H
+
+#include <atomic>
+#include <thread>
+
+#include <QByteArray>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+
+/**
+ * @brief The ChainNotifier class - subscribes to the chain events a local monerod publishes over ZMQ
+ *
+ * Listens on the daemon's --zmq-pub endpoint for the json-minimal-chain_main and json-minimal-txpool_add
+ * topics. Signals are emitted from the notifier's own thread. Any publisher sending "<topic>:<json>" frames
+ * will do, so a stand-in publisher can drive it as well as a daemon.
+ */
+class ChainNotifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ChainNotifier(QObject *parent = nullptr);
+    ~ChainNotifier();
+
+    //! (re)subscribes to the endpoint, an empty address stops listening
+    void setAddress(const QString &address);
+    QString address() const;
+    //! a notification arrived recently enough to rely on, polling may back off
+    bool live() const;
+
+signals:
+    //! the daemon's main chain grew or reorganized, height is the new daemon height
+    void newBlock(quint64 height) const;
+    //! transactions entered the daemon's pool
+    void txPoolAdded(int count) const;
+
+private:
+    void start(const QString &address);
+    void stop();
+    void run(const QString &address);
+    void handle(const QByteArray &message);
+
+private:
+    mutable QMutex m_mutex;
+    QString m_address;
+    std::thread m_thread;
+    std::atomic<bool> m_stopping;
+    // steady clock milliseconds of the last notification, 0 before the first one
+    std::atomic<qint64> m_lastNotification;
+};
+
+#endif // CHAINNOTIFIER_H
@@ -0,0 +1,118 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "RefreshPolicy.h"
+
+#include <algorithm>
+
+namespace
+{
+constexpr const std::chrono::seconds legacyInterval{10};
+constexpr const std::chrono::seconds retryDelay{1};
+constexpr const int maxRetryDoublings = 4;
+constexpr const std::chrono::seconds newBlockDelay{2};
+constexpr const std::chrono::seconds poolDelay{5};
+constexpr const std::chrono::seconds notifiedInterval{120};
+constexpr const std::chrono::seconds syncedInterval{10};
+constexpr const std::chrono::seconds idleInterval{60};
+constexpr const std::chrono::seconds hiddenInterval{180};
+constexpr const int idleAfterSeconds = 5 * 60;
+}
+
+RefreshPolicy::~RefreshPolicy()
+{
+}
+
+std::unique_ptr<RefreshPolicy> RefreshPolicy::create(const QString &name)
+{
+    if (name == "adaptive")
+    {
+        return std::unique_ptr<RefreshPolicy>(new AdaptiveRefreshPolicy());
+    }
+    if (name == "fixed")
+    {
+        return std::unique_ptr<RefreshPolicy>(new FixedRefreshPolicy(legacyInterval));
+    }
+    return nullptr;
+}
+
+FixedRefreshPolicy::FixedRefreshPolicy(std::chrono::milliseconds interval)
+    : m_interval(interval)
+{
+}
+
+QString FixedRefreshPolicy::name() const
+{
+    return "fixed";
+}
+
+RefreshDecision FixedRefreshPolicy::next(const RefreshState &) const
+{
+    return {m_interval, "interval"};
+}
+
+QString AdaptiveRefreshPolicy::name() const
+{
+    return "adaptive";
+}
+
+RefreshDecision AdaptiveRefreshPolicy::next(const RefreshState &state) const
+{
+    if (state.walletHeight > 0 && state.walletHeight < state.daemonHeight)
+    {
+        if (state.connected && state.madeProgress)
+        {
+            return {std::chrono::milliseconds::zero(), "catching up"};
+        }
+        // the daemon went away or the scan is stuck, doubling delays up to the synced interval
+        const std::chrono::milliseconds delay = retryDelay * (1 << std::min(state.stalledRefreshes, maxRetryDoublings));
+        return {std::min<std::chrono::milliseconds>(delay, syncedInterval), state.connected ? "retry" : "disconnected"};
+    }
+    if (state.daemonHeightChanged)
+    {
+        // a pushed block is already stored by the daemon, a polled one may still be settling
+        return {state.chainNotifications ? std::chrono::milliseconds::zero() : newBlockDelay, "new block"};
+    }
+    if (!state.windowVisible)
+    {
+        return {hiddenInterval, "hidden"};
+    }
+    if (state.poolChanged)
+    {
+        return {poolDelay, "mempool"};
+    }
+    if (state.chainNotifications)
+    {
+        return {notifiedInterval, "notified"};
+    }
+    if (state.idleSeconds >= idleAfterSeconds)
+    {
+        return {idleInterval, "idle"};
+    }
+    return {syncedInterval, "synced"};
+}
@@ -0,0 +1,110 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef REFRESHPOLICY_H
+#define REFRESHPOLICY_H
+
+#include <chrono>
+#include <memory>
+
+#include <QString>
+
+/**
+ * @brief The RefreshState struct - what the refresh thread knows when scheduling the next refresh
+ */
+struct RefreshState
+{
+    quint64 walletHeight;
+    quint64 daemonHeight;
+    //! the daemon answered the last status poll
+    bool connected;
+    //! the last refresh succeeded and moved the wallet height
+    bool madeProgress;
+    //! consecutive refreshes that made no progress
+    int stalledRefreshes;
+    //! the daemon reported a higher height since the last refresh
+    bool daemonHeightChanged;
+    //! the daemon announced new pool transactions since the last refresh
+    bool poolChanged;
+    //! the daemon pushes chain events, so polling is only a fallback
+    bool chainNotifications;
+    //! the application window is shown
+    bool windowVisible;
+    //! seconds since the last user input
+    int idleSeconds;
+};
+
+/**
+ * @brief The RefreshDecision struct - delay before the next refresh and why it was chosen
+ */
+struct RefreshDecision
+{
+    std::chrono::milliseconds delay;
+    QString reason;
+};
+
+/**
+ * @brief The RefreshPolicy class - decides when the wallet refreshes next
+ *
+ * Policies are stateless and only called from the wallet refresh thread.
+ */
+class RefreshPolicy
+{
+public:
+    virtual ~RefreshPolicy();
+
+    virtual QString name() const = 0;
+    //! delay counted from the last refresh, or from now if the daemon height just changed
+    virtual RefreshDecision next(const RefreshState &state) const = 0;
+
+    //! returns nullptr for an unknown policy name
+    static std::unique_ptr<RefreshPolicy> create(const QString &name);
+};
+
+//! refreshes on a constant interval regardless of chain and user activity
+class FixedRefreshPolicy : public RefreshPolicy
+{
+public:
+    explicit FixedRefreshPolicy(std::chrono::milliseconds interval);
+
+    QString name() const override;
+    RefreshDecision next(const RefreshState &state) const override;
+
+private:
+    std::chrono::milliseconds m_interval;
+};
+
+//! refreshes back-to-back while catching up, retries a stalled sync with growing delays, soon after a new block and backs off when idle, hidden or notified
+class AdaptiveRefreshPolicy : public RefreshPolicy
+{
+public:
+    QString name() const override;
+    RefreshDecision next(const RefreshState &state) const override;
+};
+
+#endif // REFRESHPOLICY_H
@@ -30,68 +30,96 @@
 #include <QDebug>
 
 Subaddress::Subaddress(Monero::Subaddress *subaddressImpl, QObject *parent)
-  : QObject(parent), m_subaddressImpl(subaddressImpl)
+  : QObject(parent), m_subaddressImpl(subaddressImpl), m_rows(std::make_shared<const Rows>())
 {
     getAll();
 }
 
 void Subaddress::getAll() const
 {
-    emit refreshStarted();
+    publish(copyRows());
+}
 
+std::shared_ptr<const Subaddress::Rows> Subaddress::copyRows() const
+{
+    // the backend owns its rows only until its next refresh, the snapshot keeps copies
+    auto rows = std::make_shared<Rows>();
     {
-        QWriteLocker locker(&m_lock);
+        QMutexLocker locker(&m_implMutex);
 
-        m_rows.clear();
-        for (auto &row: m_subaddressImpl->getAll()) {
-            m_rows.append(row);
+        for (const auto &row: m_subaddressImpl->getAll()) {
+            rows->push_back(*row);
         }
     }
+    return rows;
+}
 
+void Subaddress::publish(std::shared_ptr<const Rows> rows) const
+{
+    emit refreshStarted();
+    std::atomic_store(&m_rows, std::move(rows));
     emit refreshFinished();
 }
 
-bool Subaddress::getRow(int index, std::function<void (Monero::SubaddressRow &row)> callback) const
+bool Subaddress::getRow(int index, std::function<void (const Monero::SubaddressRow &row)> callback) const
 {
-    QReadLocker locker(&m_lock);
+    const std::shared_ptr<const Rows> rows = snapshot();
 
-    if (index < 0 || index >= m_rows.size())
+    if (index < 0 || static_cast<size_t>(index) >= rows->size())
     {
         return false;
     }
 
-    callback(*m_rows.value(index));
+    callback((*rows)[index]);
     return true;
 }
 
 void Subaddress::addRow(quint32 accountIndex, const QString &label) const
 {
-    m_subaddressImpl->addRow(accountIndex, label.toStdString());
+    {
+        QMutexLocker locker(&m_implMutex);
+
+        m_subaddressImpl->addRow(accountIndex, label.toStdString());
+    }
     getAll();
 }
 
 void Subaddress::setLabel(quint32 accountIndex, quint32 addressIndex, const QString &label) const
 {
-    m_subaddressImpl->setLabel(accountIndex, addressIndex, label.toStdString());
+    {
+        QMutexLocker locker(&m_implMutex);
+
+        m_subaddressImpl->setLabel(accountIndex, addressIndex, label.toStdString());
+    }
     getAll();
 }
 
 void Subaddress::refresh(quint32 accountIndex) const
+{
+    publish(load(accountIndex));
+}
+
+std::shared_ptr<const Subaddress::Rows> Subaddress::load(quint32 accountIndex) const
 {
     try
     {
+        QMutexLocker locker(&m_implMutex);
+
         m_subaddressImpl->refresh(accountIndex);
     }
     catch (const std::exception &e)
     {
         qCritical() << "Failed to refresh account" << accountIndex << "subaddresses:" << e.what();
     }
-    getAll();
+    return copyRows();
 }
 
 quint64 Subaddress::count() const
 {
-    QReadLocker locker(&m_lock);
+    return snapshot()->size();
+}
 
-    return m_rows.size();
+std::shared_ptr<const Subaddress::Rows> Subaddress::snapshot() const
+{
+    return std::atomic_load(&m_rows);
 }
@@ -30,23 +30,28 @@
 #define SUBADDRESS_H
 
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include <wallet/api/wallet2_api.h>
-#include <QReadWriteLock>
+#include <QMutex>
 #include <QObject>
-#include <QList>
 #include <QDateTime>
 
 class Subaddress : public QObject
 {
     Q_OBJECT
 public:
+    using Rows = std::vector<Monero::SubaddressRow>;
+
     Q_INVOKABLE void getAll() const;
-    Q_INVOKABLE bool getRow(int index, std::function<void (Monero::SubaddressRow &row)> callback) const;
+    Q_INVOKABLE bool getRow(int index, std::function<void (const Monero::SubaddressRow &row)> callback) const;
     Q_INVOKABLE void addRow(quint32 accountIndex, const QString &label) const;
     Q_INVOKABLE void setLabel(quint32 accountIndex, quint32 addressIndex, const QString &label) const;
     Q_INVOKABLE void refresh(quint32 accountIndex) const;
     quint64 count() const;
+    //! immutable snapshot of the rows, readers on any thread take no lock
+    std::shared_ptr<const Rows> snapshot() const;
 
 signals:
     void refreshStarted() const;
@@ -57,9 +62,17 @@ public slots:
 private:
     explicit Subaddress(Monero::Subaddress * subaddressImpl, QObject *parent);
     friend class Wallet;
-    mutable QReadWriteLock m_lock;
+    //! refreshes the backend rows of an account and copies them, any thread
+    std::shared_ptr<const Rows> load(quint32 accountIndex) const;
+    //! copies the backend rows, any thread
+    std::shared_ptr<const Rows> copyRows() const;
+    //! swaps the rows in, on the subaddress' thread since views reset along
+    void publish(std::shared_ptr<const Rows> rows) const;
+    // serializes the use of the backend, readers only ever load m_rows
+    mutable QMutex m_implMutex;
     Monero::Subaddress * m_subaddressImpl;
-    mutable QList<Monero::SubaddressRow*> m_rows;
+    // copies of the backend rows, swapped atomically and never modified once published
+    mutable std::shared_ptr<const Rows> m_rows;
 };
 
 #endif // SUBADDRESS_H
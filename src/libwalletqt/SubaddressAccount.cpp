@@ -27,63 +27,148 @@
 // THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "SubaddressAccount.h"
+#include "TransactionHistory.h"
 #include <QDebug>
+#include <QVariantMap>
 
-SubaddressAccount::SubaddressAccount(Monero::SubaddressAccount *subaddressAccountImpl, QObject *parent)
-  : QObject(parent), m_subaddressAccountImpl(subaddressAccountImpl)
+bool SubaddressAccount::Summary::operator==(const Summary &other) const
+{
+    return index == other.index
+        && label == other.label
+        && address == other.address
+        && balance == other.balance
+        && unlockedBalance == other.unlockedBalance
+        && subaddressCount == other.subaddressCount
+        && lastActivityHeight == other.lastActivityHeight;
+}
+
+SubaddressAccount::SubaddressAccount(Monero::SubaddressAccount *subaddressAccountImpl, Monero::Wallet *walletImpl,
+                                     const TransactionHistory *history, QObject *parent)
+  : QObject(parent), m_subaddressAccountImpl(subaddressAccountImpl), m_walletImpl(walletImpl), m_history(history)
+  , m_rows(std::make_shared<const Rows>()), m_summaries(std::make_shared<const Summaries>())
 {
     getAll();
 }
 
 void SubaddressAccount::getAll() const
 {
-    emit refreshStarted();
+    publish(load());
+}
 
+SubaddressAccount::Snapshot SubaddressAccount::load() const
+{
+    // the backend owns its rows only until its next refresh, the snapshot keeps copies;
+    // the summaries are filled in the same pass so views never have to query the wallet per account
+    auto rows = std::make_shared<Rows>();
+    auto summaries = std::make_shared<Summaries>();
+    const std::shared_ptr<const QHash<quint32, quint64>> lastActivity = m_history->lastActivityHeights();
     {
-        QWriteLocker locker(&m_lock);
-        m_rows.clear();
-        for (auto &row: m_subaddressAccountImpl->getAll()) {
-            m_rows.append(row);
+        QMutexLocker locker(&m_implMutex);
+
+        const std::vector<Monero::SubaddressAccountRow *> &all = m_subaddressAccountImpl->getAll();
+        rows->reserve(all.size());
+        summaries->reserve(all.size());
+        for (const auto &row: all) {
+            rows->push_back(*row);
+
+            Summary summary;
+            summary.index = static_cast<quint32>(row->getRowId());
+            summary.label = QString::fromStdString(row->getLabel());
+            summary.address = QString::fromStdString(row->getAddress());
+            summary.balance = m_walletImpl->balance(summary.index);
+            summary.unlockedBalance = m_walletImpl->unlockedBalance(summary.index);
+            summary.subaddressCount = static_cast<quint32>(m_walletImpl->numSubaddresses(summary.index));
+            summary.lastActivityHeight = lastActivity->value(summary.index);
+            summaries->push_back(std::move(summary));
         }
     }
+    return {std::move(rows), std::move(summaries)};
+}
 
+void SubaddressAccount::publish(const Snapshot &snapshot) const
+{
+    emit refreshStarted();
+    std::atomic_store(&m_rows, snapshot.rows);
+    std::atomic_store(&m_summaries, snapshot.summaries);
     emit refreshFinished();
+    emit summariesChanged();
 }
 
-bool SubaddressAccount::getRow(int index, std::function<void (Monero::SubaddressAccountRow &)> callback) const
+bool SubaddressAccount::getRow(int index, std::function<void (const Monero::SubaddressAccountRow &)> callback) const
 {
-    QReadLocker locker(&m_lock);
+    const std::shared_ptr<const Rows> rows = snapshot();
 
-    if (index < 0 || index >= m_rows.size())
+    if (index < 0 || static_cast<size_t>(index) >= rows->size())
     {
         return false;
     }
 
-    callback(*m_rows.value(index));
+    callback((*rows)[index]);
     return true;
 }
 
 void SubaddressAccount::addRow(const QString &label) const
 {
-    m_subaddressAccountImpl->addRow(label.toStdString());
+    {
+        QMutexLocker locker(&m_implMutex);
+
+        m_subaddressAccountImpl->addRow(label.toStdString());
+    }
     getAll();
 }
 
 void SubaddressAccount::setLabel(quint32 accountIndex, const QString &label) const
 {
-    m_subaddressAccountImpl->setLabel(accountIndex, label.toStdString());
+    {
+        QMutexLocker locker(&m_implMutex);
+
+        m_subaddressAccountImpl->setLabel(accountIndex, label.toStdString());
+    }
     getAll();
 }
 
 void SubaddressAccount::refresh() const
 {
-    m_subaddressAccountImpl->refresh();
+    {
+        QMutexLocker locker(&m_implMutex);
+
+        m_subaddressAccountImpl->refresh();
+    }
     getAll();
 }
 
 quint64 SubaddressAccount::count() const
 {
-    QReadLocker locker(&m_lock);
+    return snapshot()->size();
+}
+
+std::shared_ptr<const SubaddressAccount::Rows> SubaddressAccount::snapshot() const
+{
+    return std::atomic_load(&m_rows);
+}
 
-    return m_rows.size();
+std::shared_ptr<const SubaddressAccount::Summaries> SubaddressAccount::summaries() const
+{
+    return std::atomic_load(&m_summaries);
+}
+
+QVariantList SubaddressAccount::summary() const
+{
+    const std::shared_ptr<const Summaries> summaries = this->summaries();
+
+    QVariantList result;
+    result.reserve(static_cast<int>(summaries->size()));
+    for (const Summary &summary : *summaries)
+    {
+        QVariantMap account;
+        account["index"] = summary.index;
+        account["label"] = summary.label;
+        account["address"] = summary.address;
+        account["balance"] = summary.balance;
+        account["unlockedBalance"] = summary.unlockedBalance;
+        account["subaddressCount"] = summary.subaddressCount;
+        account["lastActivityHeight"] = summary.lastActivityHeight;
+        result.append(account);
+    }
+    return result;
 }
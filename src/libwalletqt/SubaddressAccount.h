@@ -30,36 +30,83 @@
 #define SUBADDRESSACCOUNT_H
 
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include <wallet/api/wallet2_api.h>
 #include <QObject>
-#include <QReadWriteLock>
-#include <QList>
+#include <QMutex>
 #include <QDateTime>
+#include <QVariantList>
+
+class TransactionHistory;
 
 class SubaddressAccount : public QObject
 {
     Q_OBJECT
 public:
+    using Rows = std::vector<Monero::SubaddressAccountRow>;
+
+    //! everything the account views show about one account
+    struct Summary
+    {
+        quint32 index = 0;
+        QString label;
+        QString address;
+        quint64 balance = 0;
+        quint64 unlockedBalance = 0;
+        quint32 subaddressCount = 0;
+        //! height of the latest mined transaction, 0 if there is none
+        quint64 lastActivityHeight = 0;
+
+        bool operator==(const Summary &other) const;
+        bool operator!=(const Summary &other) const { return !(*this == other); }
+    };
+    using Summaries = std::vector<Summary>;
+    //! rows and summaries built in the same pass
+    struct Snapshot
+    {
+        std::shared_ptr<const Rows> rows;
+        std::shared_ptr<const Summaries> summaries;
+    };
+
     Q_INVOKABLE void getAll() const;
-    Q_INVOKABLE bool getRow(int index, std::function<void (Monero::SubaddressAccountRow &)> callback) const;
+    Q_INVOKABLE bool getRow(int index, std::function<void (const Monero::SubaddressAccountRow &)> callback) const;
     Q_INVOKABLE void addRow(const QString &label) const;
     Q_INVOKABLE void setLabel(quint32 accountIndex, const QString &label) const;
     Q_INVOKABLE void refresh() const;
     quint64 count() const;
+    //! immutable snapshot of the rows, readers on any thread take no lock
+    std::shared_ptr<const Rows> snapshot() const;
+    //! immutable summary of every account, built alongside the rows by getAll()
+    std::shared_ptr<const Summaries> summaries() const;
+    //! the summary of every account as a list of maps, in account order
+    Q_INVOKABLE QVariantList summary() const;
 
 signals:
     void refreshStarted() const;
     void refreshFinished() const;
+    //! a new summary was published, may be emitted on any thread
+    void summariesChanged() const;
 
 public slots:
 
 private:
-    explicit SubaddressAccount(Monero::SubaddressAccount * subaddressAccountImpl, QObject *parent);
+    explicit SubaddressAccount(Monero::SubaddressAccount * subaddressAccountImpl, Monero::Wallet * walletImpl,
+                               const TransactionHistory * history, QObject *parent);
     friend class Wallet;
-    mutable QReadWriteLock m_lock;
+    //! copies the backend rows and summarizes them, any thread
+    Snapshot load() const;
+    //! swaps a snapshot in, on the account's thread since views reset along
+    void publish(const Snapshot &snapshot) const;
+    // serializes the use of the backend, readers only ever load m_rows and m_summaries
+    mutable QMutex m_implMutex;
     Monero::SubaddressAccount * m_subaddressAccountImpl;
-    mutable QList<Monero::SubaddressAccountRow*> m_rows;
+    Monero::Wallet * m_walletImpl;
+    const TransactionHistory * m_history;
+    // copies of the backend rows, swapped atomically and never modified once published
+    mutable std::shared_ptr<const Rows> m_rows;
+    mutable std::shared_ptr<const Summaries> m_summaries;
 };
 
 #endif // SUBADDRESSACCOUNT_H
@@ -0,0 +1,158 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SyncMetrics.h"
+
+#include <algorithm>
+
+namespace
+{
+double average(qint64 sum, int count)
+{
+    return count > 0 ? static_cast<double>(sum) / count : 0;
+}
+}
+
+QString SyncMetrics::Summary::toString() const
+{
+    return QString("blocks %1, %2 blocks/s, refresh %3 ms (lock wait %4 ms, wallet %5 ms, history %6 ms, "
+                   "subaddresses %7 ms, accounts %8 ms), eta %9 s over %10 samples")
+        .arg(lastBlocksScanned)
+        .arg(blocksPerSecond, 0, 'f', 1)
+        .arg(totalMs, 0, 'f', 0)
+        .arg(lockWaitMs, 0, 'f', 0)
+        .arg(walletMs, 0, 'f', 0)
+        .arg(historyMs, 0, 'f', 0)
+        .arg(subaddressMs, 0, 'f', 0)
+        .arg(subaddressAccountMs, 0, 'f', 0)
+        .arg(etaSeconds)
+        .arg(samples);
+}
+
+SyncMetrics::SyncMetrics(size_t window)
+    : m_window(window)
+    , m_remainingBlocks(0)
+{
+}
+
+SyncMetrics::Summary SyncMetrics::record(const Sample &sample, quint64 remainingBlocks)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_samples.push_back(sample);
+    while (m_samples.size() > m_window)
+    {
+        m_samples.pop_front();
+    }
+    m_remainingBlocks = remainingBlocks;
+    m_summary = summarize(remainingBlocks);
+    return m_summary;
+}
+
+SyncMetrics::Summary SyncMetrics::recordPhase(Phase phase, qint64 ms)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // nothing to attach to before the first refresh
+    if (m_samples.empty())
+    {
+        return m_summary;
+    }
+
+    Sample &sample = m_samples.back();
+    qint64 &duration = phase == Phase_History ? sample.historyMs
+        : phase == Phase_Subaddress ? sample.subaddressMs
+        : sample.subaddressAccountMs;
+    duration = std::max<qint64>(duration, 0) + ms;
+    m_summary = summarize(m_remainingBlocks);
+    return m_summary;
+}
+
+SyncMetrics::Summary SyncMetrics::summary() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_summary;
+}
+
+SyncMetrics::Summary SyncMetrics::summarize(quint64 remainingBlocks) const
+{
+    quint64 blocks = 0;
+    qint64 total = 0;
+    qint64 lockWait = 0;
+    qint64 wallet = 0;
+    qint64 history = 0;
+    qint64 subaddress = 0;
+    qint64 subaddressAccount = 0;
+    int historyCount = 0;
+    int subaddressCount = 0;
+    int subaddressAccountCount = 0;
+    for (const Sample &sample : m_samples)
+    {
+        blocks += sample.blocksScanned;
+        total += sample.totalMs;
+        lockWait += sample.lockWaitMs;
+        wallet += sample.walletMs;
+        if (sample.historyMs >= 0)
+        {
+            history += sample.historyMs;
+            ++historyCount;
+        }
+        if (sample.subaddressMs >= 0)
+        {
+            subaddress += sample.subaddressMs;
+            ++subaddressCount;
+        }
+        if (sample.subaddressAccountMs >= 0)
+        {
+            subaddressAccount += sample.subaddressAccountMs;
+            ++subaddressAccountCount;
+        }
+    }
+
+    Summary summary;
+    summary.samples = static_cast<int>(m_samples.size());
+    summary.lastBlocksScanned = m_samples.empty() ? 0 : m_samples.back().blocksScanned;
+    // the rate is taken over time spent scanning, idle time between refreshes does not count
+    summary.blocksPerSecond = wallet > 0 ? blocks * 1000.0 / wallet : 0;
+    summary.totalMs = average(total, summary.samples);
+    summary.lockWaitMs = average(lockWait, summary.samples);
+    summary.walletMs = average(wallet, summary.samples);
+    summary.historyMs = average(history, historyCount);
+    summary.subaddressMs = average(subaddress, subaddressCount);
+    summary.subaddressAccountMs = average(subaddressAccount, subaddressAccountCount);
+    if (remainingBlocks == 0)
+    {
+        summary.etaSeconds = 0;
+    }
+    else if (summary.blocksPerSecond > 0)
+    {
+        summary.etaSeconds = static_cast<qint64>(remainingBlocks / summary.blocksPerSecond);
+    }
+    return summary;
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SYNCMETRICS_H
+#define SYNCMETRICS_H
+
+#include <deque>
+
+#include <QMutex>
+#include <QString>
+
+/**
+ * @brief The SyncMetrics class - rolling window of wallet refresh timings
+ *
+ * Samples are recorded by whichever thread ran the refresh and summarized on demand.
+ * Phase durations are in milliseconds, a negative duration marks a phase that did not run.
+ */
+class SyncMetrics
+{
+public:
+    struct Sample
+    {
+        quint64 blocksScanned = 0;
+        qint64 totalMs = 0;
+        qint64 lockWaitMs = 0;
+        qint64 walletMs = 0;
+        qint64 historyMs = -1;
+        qint64 subaddressMs = -1;
+        qint64 subaddressAccountMs = -1;
+    };
+
+    //! phases that run on workers once the refresh was recorded
+    enum Phase
+    {
+        Phase_History,
+        Phase_Subaddress,
+        Phase_SubaddressAccount
+    };
+
+    struct Summary
+    {
+        int samples = 0;
+        quint64 lastBlocksScanned = 0;
+        double blocksPerSecond = 0;
+        //! averages over the samples in which the phase ran
+        double totalMs = 0;
+        double lockWaitMs = 0;
+        double walletMs = 0;
+        double historyMs = 0;
+        double subaddressMs = 0;
+        double subaddressAccountMs = 0;
+        //! seconds until the target height at the current rate, -1 when unknown
+        qint64 etaSeconds = -1;
+
+        QString toString() const;
+    };
+
+    explicit SyncMetrics(size_t window = 20);
+
+    //! records a refresh, remainingBlocks is the distance to the target height afterwards
+    Summary record(const Sample &sample, quint64 remainingBlocks);
+    //! adds the duration of a phase to the latest sample, repeated runs of a phase add up
+    Summary recordPhase(Phase phase, qint64 ms);
+    Summary summary() const;
+
+private:
+    Summary summarize(quint64 remainingBlocks) const;
+
+private:
+    mutable QMutex m_mutex;
+    const size_t m_window;
+    std::deque<Sample> m_samples;
+    quint64 m_remainingBlocks;
+    Summary m_summary;
+};
+
+#endif // SYNCMETRICS_H
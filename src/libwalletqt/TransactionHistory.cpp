@@ -28,84 +28,449 @@
 
 #include "TransactionHistory.h"
 #include "TransactionInfo.h"
+#include "WalletManager.h"
 #include <wallet/api/wallet2_api.h>
 
 #include <QFile>
 #include <QDebug>
-#include <QReadLocker>
-#include <QWriteLocker>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QVector>
+#include <QMutexLocker>
 #include <QtGlobal>
 
+namespace {
+    /**
+     * identity of a history row across refreshes, duplicates get an occurrence suffix
+     */
+    QByteArray transactionKey(const TransactionStore::Hash &hash, quint8 direction, const QVector<quint32> &subaddrIndex, QHash<QByteArray, int> &seen)
+    {
+        QByteArray key(reinterpret_cast<const char *>(hash.data()), hash.size());
+        key.append(static_cast<char>(direction));
+        for (quint32 index : subaddrIndex) {
+            key.append(reinterpret_cast<const char *>(&index), sizeof(index));
+        }
 
-bool TransactionHistory::transaction(int index, std::function<void (TransactionInfo &)> callback)
-{
-    QReadLocker locker(&m_lock);
+        const int occurrence = seen.value(key, 0);
+        seen.insert(key, occurrence + 1);
+        if (occurrence > 0) {
+            key.append('#').append(QByteArray::number(occurrence));
+        }
+        return key;
+    }
+
+    QByteArray transactionKey(const TransactionStore &store, int row, QHash<QByteArray, int> &seen)
+    {
+        QVector<quint32> subaddrIndex;
+        subaddrIndex.reserve(store.subaddrIndexCount(row));
+        for (int i = 0; i < store.subaddrIndexCount(row); ++i) {
+            subaddrIndex.append(store.subaddrIndex(row, i));
+        }
+        return transactionKey(store.rawHash(row), store.direction(row), subaddrIndex, seen);
+    }
+
+    QByteArray transactionKey(const Monero::TransactionInfo &tx, QHash<QByteArray, int> &seen)
+    {
+        QVector<quint32> subaddrIndex;
+        for (uint32_t index : tx.subaddrIndex()) {
+            subaddrIndex.append(index);
+        }
+        return transactionKey(TransactionStore::parseHash(tx.hash()), tx.direction(), subaddrIndex, seen);
+    }
+
+    const char *exportDirection(TransactionInfo::Direction direction)
+    {
+        switch (direction) {
+        case TransactionInfo::Direction_In:
+            return "in";
+        case TransactionInfo::Direction_Out:
+            return "out";
+        default:
+            return nullptr;
+        }
+    }
+
+    QString exportPaymentId(const TransactionStore &txs, int row)
+    {
+        const QString paymentId = txs.paymentId(row);
+        return paymentId == "0000000000000000" ? QString() : paymentId;
+    }
+
+    QByteArray exportDate(qint64 epoch)
+    {
+        const QDateTime timeStamp = QDateTime::fromSecsSinceEpoch(epoch);
+        return (timeStamp.date().toString(Qt::ISODate) + " " + timeStamp.time().toString(Qt::ISODate)).toUtf8();
+    }
+
+    void appendCSVRow(QByteArray &buffer, const TransactionStore &txs, int row, const char *direction)
+    {
+        QString label = txs.label(row);
+        label.remove(QChar('"'));  // reserved
+        QString description = txs.description(row);
+        description.remove(QChar('"')); // reserved
+
+        buffer += QByteArray::number(txs.blockHeight(row));
+        buffer += ',';
+        buffer += QByteArray::number(txs.timestamp(row));
+        buffer += ',';
+        buffer += exportDate(txs.timestamp(row));
+        buffer += ',';
+        buffer += direction;
+        buffer += ',';
+        buffer += WalletManager::displayAmount(txs.amount(row)).toUtf8();
+        buffer += ',';
+        buffer += QByteArray::number(txs.amount(row));
+        buffer += ',';
+        if (txs.fee(row) != 0) {
+            buffer += WalletManager::displayAmount(txs.fee(row)).toUtf8();
+        }
+        buffer += ',';
+        buffer += txs.hash(row).toUtf8();
+        buffer += ",\"";
+        buffer += label.toUtf8();
+        buffer += "\",";
+        buffer += QByteArray::number(txs.subaddrAccount(row));
+        buffer += ',';
+        buffer += exportPaymentId(txs, row).toUtf8();
+        buffer += ",\"";
+        buffer += description.toUtf8();
+        buffer += "\"\n";
+    }
 
-    if (index < 0 || index >= m_tinfo.size()) {
+    void appendJSONRow(QByteArray &buffer, const TransactionStore &txs, int row, const char *direction)
+    {
+        // atomic amounts are strings, they don't fit into a double
+        QJsonObject object;
+        object.insert("blockHeight", static_cast<qint64>(txs.blockHeight(row)));
+        object.insert("epoch", txs.timestamp(row));
+        object.insert("date", QString::fromUtf8(exportDate(txs.timestamp(row))));
+        object.insert("direction", QString::fromLatin1(direction));
+        object.insert("amount", WalletManager::displayAmount(txs.amount(row)));
+        object.insert("atomicAmount", QString::number(txs.amount(row)));
+        object.insert("fee", txs.fee(row) == 0 ? QString() : WalletManager::displayAmount(txs.fee(row)));
+        object.insert("atomicFee", QString::number(txs.fee(row)));
+        object.insert("txid", txs.hash(row));
+        object.insert("label", txs.label(row));
+        object.insert("subaddrAccount", static_cast<qint64>(txs.subaddrAccount(row)));
+        object.insert("paymentId", exportPaymentId(txs, row));
+        object.insert("description", txs.description(row));
+        buffer += QJsonDocument(object).toJson(QJsonDocument::Compact);
+        buffer += '\n';
+    }
+}
+
+
+bool TransactionHistory::transaction(int index, std::function<void (const TransactionStore &, int)> callback) const
+{
+    const std::shared_ptr<const TransactionStore> store = snapshot();
+    if (index < 0 || index >= store->size()) {
         qCritical("%s: no transaction info for index %d", __FUNCTION__, index);
-        qCritical("%s: there's %d transactions in backend", __FUNCTION__, m_pimpl->count());
         return false;
     }
 
-    callback(*m_tinfo.value(index));
+    callback(*store, index);
     return true;
 }
 
-//// XXX: not sure if this method really needed;
-//TransactionInfo *TransactionHistory::transaction(const QString &id)
-//{
-//    return nullptr;
-//}
+TransactionInfo *TransactionHistory::transaction(int index) const
+{
+    const std::shared_ptr<const TransactionStore> store = snapshot();
+    if (index < 0 || index >= store->size()) {
+        qCritical("%s: no transaction info for index %d", __FUNCTION__, index);
+        return nullptr;
+    }
+
+    return new TransactionInfo(*store, index);
+}
 
 void TransactionHistory::refresh(quint32 accountIndex)
 {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-    QDateTime firstDateTime = QDate(2014, 4, 18).startOfDay();
-#else
-    QDateTime firstDateTime = QDateTime(QDate(2014, 4, 18)); // the genesis block
-#endif
-    QDateTime lastDateTime  = QDateTime::currentDateTime().addDays(1); // tomorrow (guard against jitter and timezones)
+    applyRefresh(buildRefresh(accountIndex, m_accountIndex, m_revision, m_accounts));
+}
+
+void TransactionHistory::refreshAsync(quint32 accountIndex)
+{
+    m_refreshAccount = accountIndex;
+    if (m_refreshRunning) {
+        m_refreshQueued = true;
+        return;
+    }
+    startRefresh();
+}
+
+void TransactionHistory::showAccount(quint32 accountIndex)
+{
+    if (!m_populated) {
+        refresh(accountIndex);
+        return;
+    }
+    if (m_accountIndex == accountIndex) {
+        return;
+    }
 
     emit refreshStarted();
+    m_accounts[accountIndex];
+    m_accountIndex = accountIndex;
+    ++m_revision;
+    publish();
+    emit refreshFinished();
+
+    updateScope();
+}
+
+void TransactionHistory::startRefresh()
+{
+    // back buffers start as copies sharing the columns of the shown stores
+    QMap<quint32, TransactionStore> accounts = m_accounts;
+    const quint32 accountIndex = m_refreshAccount;
+    const quint32 shownAccount = m_accountIndex;
+    const quint64 revision = m_revision;
+    m_refreshRunning = true;
+    m_refreshQueued = false;
+
+    const auto future = m_scheduler.run([this, accountIndex, shownAccount, revision, accounts]() mutable {
+        RefreshResult result;
+        const auto build = [&] {
+            result = buildRefresh(accountIndex, shownAccount, revision, std::move(accounts));
+        };
+        if (m_runBuild) {
+            m_runBuild(build);
+        } else {
+            build();
+        }
+        {
+            QMutexLocker locker(&m_refreshResultMutex);
+
+            m_refreshResult = std::move(result);
+        }
+        emit refreshBuilt();
+    }, FutureScheduler::Lane::Dedicated, FutureScheduler::Priority_Normal, "history refresh");
+    if (!future.first) {
+        m_refreshRunning = false;
+    }
+}
 
+void TransactionHistory::onRefreshBuilt()
+{
+    RefreshResult result;
     {
-        QWriteLocker locker(&m_lock);
+        QMutexLocker locker(&m_refreshResultMutex);
 
-        qDeleteAll(m_tinfo);
-        m_tinfo.clear();
+        result = std::move(m_refreshResult);
+        m_refreshResult = RefreshResult();
+    }
+    m_refreshRunning = false;
 
-        quint64 lastTxHeight = 0;
-        m_locked = false;
-        m_minutesToUnlock = 0;
+    // a synchronous refresh or an account switch got in between, the result no longer fits
+    if (!applyRefresh(result)) {
+        m_refreshQueued = true;
+    }
+    if (m_refreshQueued) {
+        startRefresh();
+    }
+}
 
-        m_pimpl->refresh();
-        for (const auto i : m_pimpl->getAll()) {
-            if (i->subaddrAccount() != accountIndex) {
-                continue;
-            }
+TransactionHistory::RefreshResult TransactionHistory::buildRefresh(quint32 accountIndex, quint32 shownAccount, quint64 revision, QMap<quint32, TransactionStore> accounts)
+{
+    RefreshResult result;
+    result.revision = revision;
+    result.accountIndex = accountIndex;
+
+    // backend transactions are owned by m_pimpl and only live until its next refresh
+    QMutexLocker locker(&m_pimplMutex);
+
+    m_pimpl->refresh();
+    QMap<quint32, QVector<Monero::TransactionInfo *>> txs;
+    for (const auto i : m_pimpl->getAll()) {
+        txs[i->subaddrAccount()].append(i);
+        if (i->blockHeight() > result.lastActivity.value(i->subaddrAccount())) {
+            result.lastActivity.insert(i->subaddrAccount(), i->blockHeight());
+        }
+    }
+
+    // every account gets a store, even without transactions
+    accounts[accountIndex];
+    for (auto it = txs.constBegin(); it != txs.constEnd(); ++it) {
+        accounts[it.key()];
+    }
+
+    for (auto it = accounts.begin(); it != accounts.end(); ++it) {
+        merge(it.value(), txs.value(it.key()), it.key() == shownAccount ? &result : nullptr);
+    }
+    result.accounts = std::move(accounts);
+    return result;
+}
+
+bool TransactionHistory::applyRefresh(const RefreshResult &result)
+{
+    if (result.revision != m_revision) {
+        return false;
+    }
+    ++m_revision;
+    std::atomic_store(&m_lastActivity, std::make_shared<const QHash<quint32, quint64>>(result.lastActivity));
+
+    const bool switching = !m_populated || m_accountIndex != result.accountIndex;
+    if (switching) {
+        emit refreshStarted();
+        m_accounts = result.accounts;
+        m_accountIndex = result.accountIndex;
+        m_populated = true;
+        publish();
+        emit refreshFinished();
+    } else {
+        // replays the row removals on the shown store so that views can follow, then swaps
+        // the back buffers in; what's left differs from them in place or by appended rows only
+        for (const ChangeRange &range : result.removed) {
+            emit transactionsAboutToBeRemoved(range.first, range.last);
+            m_accounts[m_accountIndex].remove(range.first, range.last - range.first + 1);
+            publish();
+            emit transactionsRemoved();
+        }
+
+        const int first = m_accounts.value(m_accountIndex).size();
+        if (result.inserted > 0) {
+            emit transactionsAboutToBeInserted(first, first + result.inserted - 1);
+        }
+        m_accounts = result.accounts;
+        publish();
+        if (result.inserted > 0) {
+            emit transactionsInserted();
+        }
+
+        for (const ChangeRange &range : result.changed) {
+            emit transactionsChanged(range.first, range.last, range.confirmationsOnly);
+        }
+    }
+
+    updateScope();
+    emit refreshed();
+    return true;
+}
 
-            m_tinfo.append(new TransactionInfo(i, this));
+void TransactionHistory::merge(TransactionStore &store, const QVector<Monero::TransactionInfo *> &txs, RefreshResult *changes)
+{
+    // Rows are matched by tx hash, direction and subaddress indices. Matched rows keep their
+    // position, vanished rows are removed and new ones are appended, sorting is up to the proxy model.
+    // Only rows that actually changed are converted from the backend representation.
+    QHash<QByteArray, int> freshKeys;
+    QHash<QByteArray, int> freshRows;
+    freshRows.reserve(txs.size());
+    for (int row = 0; row < txs.size(); ++row) {
+        freshRows.insert(transactionKey(*txs[row], freshKeys), row);
+    }
+
+    QHash<QByteArray, int> currentKeys;
+    QVector<int> matches(store.size(), -1);
+    for (int row = 0; row < store.size(); ++row) {
+        matches[row] = freshRows.value(transactionKey(store, row, currentKeys), -1);
+    }
+
+    // removals, back to front so that pending indices stay valid
+    for (int row = matches.size() - 1; row >= 0; --row) {
+        if (matches[row] >= 0) {
+            continue;
+        }
+        const int last = row;
+        while (row > 0 && matches[row - 1] < 0) {
+            --row;
+        }
+
+        store.remove(row, last - row + 1);
+        matches.remove(row, last - row + 1);
+        if (changes) {
+            changes->removed.append({row, last, false});
+        }
+    }
+
+    // in-place updates of the remaining rows
+    QVector<bool> used(txs.size(), false);
+    QVector<char> kinds(matches.size(), 0); // 0 - unchanged, 1 - confirmations only, 2 - anything else
+    for (int row = 0; row < matches.size(); ++row) {
+        const Monero::TransactionInfo &tx = *txs[matches[row]];
+        used[matches[row]] = true;
+
+        if (!store.sameState(row, tx)) {
+            store.assign(row, tx);
+            kinds[row] = 2;
+        } else if (store.confirmations(row) != tx.confirmations()) {
+            store.setConfirmations(row, tx.confirmations());
+            kinds[row] = 1;
+        }
+    }
+    for (int row = 0; changes && row < kinds.size(); ++row) {
+        if (kinds[row] == 0) {
+            continue;
+        }
+        const char kind = kinds[row];
+        const int first = row;
+        while (row + 1 < kinds.size() && kinds[row + 1] == kind) {
+            ++row;
+        }
+        changes->changed.append({first, row, kind == 1});
+    }
 
-            const TransactionInfo *ti = m_tinfo.back();
+    // insertions
+    for (int row = 0; row < txs.size(); ++row) {
+        if (!used[row]) {
+            store.append(*txs[row]);
+            if (changes) {
+                ++changes->inserted;
+            }
+        }
+    }
+}
+
+void TransactionHistory::updateScope()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    QDateTime firstDateTime = QDate(2014, 4, 18).startOfDay();
+#else
+    QDateTime firstDateTime = QDateTime(QDate(2014, 4, 18)); // the genesis block
+#endif
+    QDateTime lastDateTime  = QDateTime::currentDateTime().addDays(1); // tomorrow (guard against jitter and timezones)
+    const qint64 genesisTimestamp = firstDateTime.toSecsSinceEpoch();
+    const qint64 tomorrowTimestamp = lastDateTime.toSecsSinceEpoch();
+    qint64 firstTimestamp = genesisTimestamp;
+    qint64 lastTimestamp = tomorrowTimestamp;
+
+    quint64 lastTxHeight = 0;
+    bool locked = false;
+    int minutesToUnlock = 0;
+    {
+        const std::shared_ptr<const TransactionStore> store = snapshot();
+        for (int row = 0; row < store->size(); ++row) {
             // looking for transactions timestamp scope
-            if (ti->timestamp() >= lastDateTime) {
-                lastDateTime = ti->timestamp();
+            const qint64 timestamp = store->timestamp(row);
+            if (timestamp >= lastTimestamp) {
+                lastTimestamp = timestamp;
             }
-            if (ti->timestamp() <= firstDateTime) {
-                firstDateTime = ti->timestamp();
+            if (timestamp <= firstTimestamp) {
+                firstTimestamp = timestamp;
             }
-            quint64 requiredConfirmations = (ti->blockHeight() < ti->unlockTime()) ? ti->unlockTime() - ti->blockHeight() : 10;
+            const quint64 blockHeight = store->blockHeight(row);
+            const quint64 unlockTime = store->unlockTime(row);
+            const quint64 confirmations = store->confirmations(row);
+            quint64 requiredConfirmations = (blockHeight < unlockTime) ? unlockTime - blockHeight : 10;
             // store last tx height
-            if (ti->confirmations() < requiredConfirmations && ti->blockHeight() >= lastTxHeight) {
-                lastTxHeight = ti->blockHeight();
+            if (confirmations < requiredConfirmations && blockHeight >= lastTxHeight) {
+                lastTxHeight = blockHeight;
                 // TODO: Fetch block time and confirmations needed from wallet2?
-                m_minutesToUnlock = (requiredConfirmations - ti->confirmations()) * 2;
-                m_locked = true;
+                minutesToUnlock = (requiredConfirmations - confirmations) * 2;
+                locked = true;
             }
         }
     }
+    m_locked = locked;
+    m_minutesToUnlock = minutesToUnlock;
 
-    emit refreshFinished();
+    if (firstTimestamp != genesisTimestamp) {
+        firstDateTime = QDateTime::fromSecsSinceEpoch(firstTimestamp);
+    }
+    if (lastTimestamp != tomorrowTimestamp) {
+        lastDateTime = QDateTime::fromSecsSinceEpoch(lastTimestamp);
+    }
 
     if (m_firstDateTime != firstDateTime) {
         m_firstDateTime = firstDateTime;
@@ -117,11 +482,25 @@ void TransactionHistory::refresh(quint32 accountIndex)
     }
 }
 
+void TransactionHistory::publish()
+{
+    // the copy shares the columns with the account store
+    std::atomic_store(&m_shown, std::make_shared<const TransactionStore>(m_accounts.value(m_accountIndex)));
+}
+
 quint64 TransactionHistory::count() const
 {
-    QReadLocker locker(&m_lock);
+    return snapshot()->size();
+}
+
+std::shared_ptr<const TransactionStore> TransactionHistory::snapshot() const
+{
+    return std::atomic_load(&m_shown);
+}
 
-    return m_tinfo.count();
+std::shared_ptr<const QHash<quint32, quint64>> TransactionHistory::lastActivityHeights() const
+{
+    return std::atomic_load(&m_lastActivity);
 }
 
 QDateTime TransactionHistory::firstDateTime() const
@@ -146,8 +525,14 @@ bool TransactionHistory::TransactionHistory::locked() const
 
 
 TransactionHistory::TransactionHistory(Monero::TransactionHistory *pimpl, QObject *parent)
-    : QObject(parent), m_pimpl(pimpl), m_minutesToUnlock(0), m_locked(false)
+    : QObject(parent), m_pimpl(pimpl), m_accountIndex(0), m_populated(false)
+    , m_shown(std::make_shared<const TransactionStore>()), m_lastActivity(std::make_shared<const QHash<quint32, quint64>>())
+    , m_minutesToUnlock(0), m_locked(false)
+    , m_revision(0), m_refreshAccount(0), m_refreshRunning(false), m_refreshQueued(false)
+    , m_exporting(false), m_scheduler(this)
 {
+    connect(this, &TransactionHistory::refreshBuilt, this, &TransactionHistory::onRefreshBuilt, Qt::QueuedConnection);
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
     m_firstDateTime = QDate(2014, 4, 18).startOfDay();
 #else
@@ -156,69 +541,141 @@ TransactionHistory::TransactionHistory(Monero::TransactionHistory *pimpl, QObjec
     m_lastDateTime = QDateTime::currentDateTime().addDays(1); // tomorrow (guard against jitter and timezones)
 }
 
+TransactionHistory::~TransactionHistory()
+{
+    shutdown();
+}
+
+void TransactionHistory::shutdown()
+{
+    m_scheduler.shutdownWaitForFinished();
+}
+
 QString TransactionHistory::writeCSV(quint32 accountIndex, QString out)
 {
     // construct filename
     qint64 now = QDateTime::currentDateTime().currentMSecsSinceEpoch();
     QString fn = QString(QString("%1/monero-txs_%2.csv").arg(out, QString::number(now / 1000)));
 
-    // open file
-    QFile data(fn);
-    if(!data.open(QFile::WriteOnly | QFile::Truncate)){
-        return QString("");
+    return writeExport(exportSnapshot(accountIndex), fn, ExportFormat_CSV);
+}
+
+bool TransactionHistory::exportAsync(int accountIndex, const QString &out, ExportFormat format)
+{
+    bool expected = false;
+    if (!m_exporting.compare_exchange_strong(expected, true)) {
+        return false;
     }
 
-    // write header
-    QTextStream output(&data);
-    output << "blockHeight,epoch,date,direction,amount,atomicAmount,fee,txid,label,subaddrAccount,paymentId,description\n";
+    // construct filename
+    qint64 now = QDateTime::currentDateTime().currentMSecsSinceEpoch();
+    const QString scope = accountIndex < 0 ? QString("monero-txs-all") : QString("monero-txs");
+    const QString extension = format == ExportFormat_JSONLines ? QString("jsonl") : QString("csv");
+    const QString fn = QString("%1/%2_%3.%4").arg(out, scope, QString::number(now / 1000), extension);
+
+    // the snapshot shares the columns with the account stores, later refreshes detach from it
+    const QMap<quint32, TransactionStore> accounts = exportSnapshot(accountIndex);
+    const auto future = m_scheduler.run([this, accounts, fn, format] {
+        const QString written = writeExport(accounts, fn, format);
+        const bool cancelled = FutureScheduler::cancelled();
+        m_exporting = false;
+        emit exportFinished(written, cancelled);
+    }, FutureScheduler::Lane::Background, FutureScheduler::Priority_Low);
+    if (!future.first) {
+        m_exporting = false;
+        return false;
+    }
+    m_exportToken = future.token;
+    return true;
+}
+
+void TransactionHistory::cancelExport()
+{
+    m_exportToken.cancel();
+}
+
+QMap<quint32, TransactionStore> TransactionHistory::exportSnapshot(int accountIndex) const
+{
+    if (m_populated) {
+        if (accountIndex < 0) {
+            return m_accounts;
+        }
+        QMap<quint32, TransactionStore> accounts;
+        accounts.insert(accountIndex, m_accounts.value(accountIndex));
+        return accounts;
+    }
 
-    QReadLocker locker(&m_lock);
+    QMap<quint32, TransactionStore> accounts;
+    if (accountIndex >= 0) {
+        accounts.insert(accountIndex, TransactionStore());
+    }
+    QMutexLocker pimplLocker(&m_pimplMutex);
     for (const auto &tx : m_pimpl->getAll()) {
-        if (tx->subaddrAccount() != accountIndex) {
-            continue;
+        if (accountIndex < 0 || tx->subaddrAccount() == static_cast<quint32>(accountIndex)) {
+            accounts[tx->subaddrAccount()].append(*tx);
         }
+    }
+    return accounts;
+}
 
-        TransactionInfo info(tx, this);
+QString TransactionHistory::writeExport(const QMap<quint32, TransactionStore> &accounts, const QString &fileName, ExportFormat format) const
+{
+    // nothing reaches the file name unless the whole export succeeds
+    QSaveFile data(fileName);
+    if (!data.open(QIODevice::WriteOnly)) {
+        return QString("");
+    }
 
-        // collect column data
-        quint64 atomicAmount = info.atomicAmount();
-        quint32 subaddrAccount = info.subaddrAccount();
-        QString fee = info.fee();
-        QString direction = QString("");
-        TransactionInfo::Direction _direction = info.direction();
-        if(_direction == TransactionInfo::Direction_In)
-        {
-            direction = QString("in");
-        }
-        else if(_direction == TransactionInfo::Direction_Out){
-            direction = QString("out");
-        }
-        else {
-            continue;  // skip TransactionInfo::Direction_Both
+    int total = 0;
+    for (const TransactionStore &txs : accounts) {
+        total += txs.size();
+    }
+
+    static constexpr int flushSize = 1 << 16;
+    static constexpr int progressInterval = 1000;
+
+    QByteArray buffer;
+    buffer.reserve(flushSize + 1024);
+    if (format == ExportFormat_CSV) {
+        // write header
+        buffer += "blockHeight,epoch,date,direction,amount,atomicAmount,fee,txid,label,subaddrAccount,paymentId,description\n";
+    }
+
+    int done = 0;
+    for (const TransactionStore &txs : accounts) {
+        for (int row = 0; row < txs.size(); ++row, ++done) {
+            if (done % progressInterval == 0) {
+                if (FutureScheduler::cancelled()) {
+                    data.cancelWriting();
+                    return QString("");
+                }
+                emit exportProgress(done, total);
+            }
+
+            const char *direction = exportDirection(txs.direction(row));
+            if (!direction) {
+                continue;  // skip TransactionInfo::Direction_Both
+            }
+
+            if (format == ExportFormat_JSONLines) {
+                appendJSONRow(buffer, txs, row, direction);
+            } else {
+                appendCSVRow(buffer, txs, row, direction);
+            }
+
+            if (buffer.size() >= flushSize) {
+                if (data.write(buffer) != buffer.size()) {
+                    data.cancelWriting();
+                    return QString("");
+                }
+                buffer.clear();
+            }
         }
-        QString label = info.label();
-        label.remove(QChar('"'));  // reserved
-        QString description = info.description();
-        description.remove(QChar('"')); // reserved
-        quint64 blockHeight = info.blockHeight();
-        QDateTime timeStamp = info.timestamp();
-        QString date = info.date() + " " + info.time();
-        uint epoch = timeStamp.toTime_t();
-        QString displayAmount = info.displayAmount();
-        QString paymentId = info.paymentId();
-        if(paymentId == "0000000000000000"){
-            paymentId = "";
-        }
-
-        // format and write
-        QString line = QString("%1,%2,%3,%4,%5,%6,%7,%8,\"%9\",%10,%11,\"%12\"\n")
-            .arg(QString::number(blockHeight), QString::number(epoch), date)
-            .arg(direction, displayAmount, QString::number(atomicAmount))
-            .arg(info.fee(), info.hash(), label, QString::number(subaddrAccount))
-            .arg(paymentId, description);
-        output << line;
-    }
-
-    data.close();
-    return fn;
+    }
+
+    if (data.write(buffer) != buffer.size() || !data.commit()) {
+        return QString("");
+    }
+    emit exportProgress(total, total);
+    return fileName;
 }
@@ -29,15 +29,23 @@
 #ifndef TRANSACTIONHISTORY_H
 #define TRANSACTIONHISTORY_H
 
+#include <atomic>
 #include <functional>
+#include <memory>
 
 #include <QObject>
-#include <QList>
-#include <QReadWriteLock>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QVector>
 #include <QDateTime>
 
+#include "TransactionStore.h"
+#include "qt/FutureScheduler.h"
+
 namespace Monero {
 struct TransactionHistory;
+struct TransactionInfo;
 }
 
 class TransactionInfo;
@@ -52,11 +60,34 @@ class TransactionHistory : public QObject
     Q_PROPERTY(bool locked READ locked)
 
 public:
-    Q_INVOKABLE bool transaction(int index, std::function<void (TransactionInfo &)> callback);
-    // Q_INVOKABLE TransactionInfo * transaction(const QString &id);
+    enum ExportFormat {
+        ExportFormat_CSV,
+        ExportFormat_JSONLines
+    };
+    Q_ENUM(ExportFormat)
+
+    ~TransactionHistory();
+
+    bool transaction(int index, std::function<void (const TransactionStore &, int)> callback) const;
+    //! builds a standalone TransactionInfo object, ownership is passed to the caller
+    Q_INVOKABLE TransactionInfo * transaction(int index) const;
     Q_INVOKABLE void refresh(quint32 accountIndex);
+    //! refreshes on a worker and swaps the result in on the history's thread, requests made
+    //! while one is running are coalesced into a single follow-up refresh of the latest account
+    Q_INVOKABLE void refreshAsync(quint32 accountIndex);
+    //! switches the shown account without querying the backend, falls back to refresh() before the first one
+    Q_INVOKABLE void showAccount(quint32 accountIndex);
     Q_INVOKABLE QString writeCSV(quint32 accountIndex, QString out);
+    //! streams the history of an account, or of every account for a negative index, into a new
+    //! file in the out directory on a worker; returns false if another export is still running
+    Q_INVOKABLE bool exportAsync(int accountIndex, const QString &out, ExportFormat format);
+    //! stops the running export, it finishes with an empty path and nothing left on disk
+    Q_INVOKABLE void cancelExport();
     quint64 count() const;
+    //! immutable snapshot of the shown account's rows, readers on any thread take no lock
+    std::shared_ptr<const TransactionStore> snapshot() const;
+    //! height of the latest mined transaction of every account with one, as of the last refresh
+    std::shared_ptr<const QHash<quint32, quint64>> lastActivityHeights() const;
     QDateTime firstDateTime() const;
     QDateTime lastDateTime() const;
     quint64 minutesToUnlock() const;
@@ -65,25 +96,98 @@ public:
 signals:
     void refreshStarted() const;
     void refreshFinished() const;
+    // incremental updates, emitted when a refresh doesn't change the shown account
+    void transactionsAboutToBeRemoved(int first, int last) const;
+    void transactionsRemoved() const;
+    void transactionsAboutToBeInserted(int first, int last) const;
+    void transactionsInserted() const;
+    void transactionsChanged(int first, int last, bool confirmationsOnly) const;
+    //! emitted once a refresh has been applied, by refresh() and refreshAsync() alike
+    void refreshed() const;
+    //! emitted by the refresh worker, the result is applied on the history's thread
+    void refreshBuilt() const;
     void firstDateTimeChanged() const;
     void lastDateTimeChanged() const;
+    void exportProgress(int written, int total) const;
+    //! path is empty when the export failed or was cancelled
+    void exportFinished(const QString &path, bool cancelled) const;
 
 public slots:
 
+private slots:
+    void onRefreshBuilt();
 
 private:
+    struct ChangeRange {
+        int first;
+        int last;
+        bool confirmationsOnly;
+    };
+    // merged back buffers of a refresh, along with the changes made to the shown account's rows
+    struct RefreshResult {
+        // m_revision of the stores the refresh was merged onto
+        quint64 revision = 0;
+        quint32 accountIndex = 0;
+        QMap<quint32, TransactionStore> accounts;
+        // removals in the order they were made, each range valid after the previous ones
+        QVector<ChangeRange> removed;
+        // changed rows, after the removals
+        QVector<ChangeRange> changed;
+        // rows appended after the removals
+        int inserted = 0;
+        QHash<quint32, quint64> lastActivity;
+    };
+
     explicit TransactionHistory(Monero::TransactionHistory * pimpl, QObject *parent = 0);
+    //! waits for the workers, the backend history must stay alive until this returns
+    void shutdown();
+    void startRefresh();
+    //! refreshes the backend and merges it into the given copies of the stores, any thread
+    RefreshResult buildRefresh(quint32 accountIndex, quint32 shownAccount, quint64 revision, QMap<quint32, TransactionStore> accounts);
+    //! swaps the back buffers in, fails if the stores changed since the refresh was built on them
+    bool applyRefresh(const RefreshResult &result);
+    static void merge(TransactionStore &store, const QVector<Monero::TransactionInfo *> &txs, RefreshResult *changes);
+    void updateScope();
+    //! publishes the shown account's store as the new snapshot
+    void publish();
+    //! copies of the stores to export, every account for a negative index
+    QMap<quint32, TransactionStore> exportSnapshot(int accountIndex) const;
+    //! writes the snapshot on the calling thread, returns the file name or an empty string;
+    //! stops early once the calling scheduler task is cancelled
+    QString writeExport(const QMap<quint32, TransactionStore> &accounts, const QString &fileName, ExportFormat format) const;
 
 private:
     friend class Wallet;
-    mutable QReadWriteLock m_lock;
+    // serializes every use of m_pimpl, workers included
+    mutable QMutex m_pimplMutex;
     Monero::TransactionHistory * m_pimpl;
-    mutable QList<TransactionInfo*> m_tinfo;
+    // every account's transactions in stable positions, rows of the shown account are model rows;
+    // only touched on the history's thread, everybody else reads m_shown
+    QMap<quint32, TransactionStore> m_accounts;
+    quint32 m_accountIndex;
+    bool m_populated;
+    // swapped atomically, never modified once published
+    std::shared_ptr<const TransactionStore> m_shown;
+    std::shared_ptr<const QHash<quint32, quint64>> m_lastActivity;
     mutable QDateTime   m_firstDateTime;
     mutable QDateTime   m_lastDateTime;
     mutable int m_minutesToUnlock;
     // history contains locked transfers
     mutable bool m_locked;
+    // bumped whenever the stores or the shown account change
+    quint64 m_revision;
+    quint32 m_refreshAccount;
+    bool m_refreshRunning;
+    bool m_refreshQueued;
+    QMutex m_refreshResultMutex;
+    RefreshResult m_refreshResult;
+    // runs the build of an async refresh on its worker, set by the wallet to time it and to keep
+    // it clear of wallet2 scans
+    std::function<void (const std::function<void ()> &)> m_runBuild;
+    std::atomic<bool> m_exporting;
+    //! token of the running async export, each export gets its own
+    CancellationToken m_exportToken;
+    FutureScheduler m_scheduler;
 
 };
 
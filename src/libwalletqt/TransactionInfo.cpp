@@ -27,6 +27,7 @@
 // THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "TransactionInfo.h"
+#include "TransactionStore.h"
 #include "WalletManager.h"
 #include "Transfer.h"
 #include <QDateTime>
@@ -146,31 +147,31 @@ QString TransactionInfo::destinations_formatted() const
     return destinations;
 }
 
-TransactionInfo::TransactionInfo(const Monero::TransactionInfo *pimpl, QObject *parent)
+TransactionInfo::TransactionInfo(const TransactionStore &store, int row, QObject *parent)
     : QObject(parent)
-    , m_amount(pimpl->amount())
-    , m_blockHeight(pimpl->blockHeight())
-    , m_confirmations(pimpl->confirmations())
-    , m_direction(static_cast<Direction>(pimpl->direction()))
-    , m_failed(pimpl->isFailed())
-    , m_coinbase(pimpl->isCoinbase())
-    , m_fee(pimpl->fee())
-    , m_hash(QString::fromStdString(pimpl->hash()))
-    , m_label(QString::fromStdString(pimpl->label()))
-    , m_paymentId(QString::fromStdString(pimpl->paymentId()))
-    , m_description(QString::fromStdString(pimpl->description()))
-    , m_pending(pimpl->isPending())
-    , m_subaddrAccount(pimpl->subaddrAccount())
-    , m_timestamp(QDateTime::fromTime_t(pimpl->timestamp()))
-    , m_unlockTime(pimpl->unlockTime())
-{
-    for (auto const &t: pimpl->transfers())
+    , m_amount(store.amount(row))
+    , m_blockHeight(store.blockHeight(row))
+    , m_confirmations(store.confirmations(row))
+    , m_direction(store.direction(row))
+    , m_failed(store.isFailed(row))
+    , m_fee(store.fee(row))
+    , m_hash(store.hash(row))
+    , m_label(store.label(row))
+    , m_paymentId(store.paymentId(row))
+    , m_description(store.description(row))
+    , m_pending(store.isPending(row))
+    , m_coinbase(store.isCoinbase(row))
+    , m_subaddrAccount(store.subaddrAccount(row))
+    , m_timestamp(QDateTime::fromSecsSinceEpoch(store.timestamp(row)))
+    , m_unlockTime(store.unlockTime(row))
+{
+    for (int i = 0; i < store.transferCount(row); ++i)
     {
-        Transfer *transfer = new Transfer(t.amount, QString::fromStdString(t.address), this);
+        Transfer *transfer = new Transfer(store.transferAmount(row, i), store.transferAddress(row, i), this);
         m_transfers.append(transfer);
     }
-    for (uint32_t i : pimpl->subaddrIndex())
+    for (int i = 0; i < store.subaddrIndexCount(row); ++i)
     {
-        m_subaddrIndex.insert(i);
+        m_subaddrIndex.insert(store.subaddrIndex(row, i));
     }
 }
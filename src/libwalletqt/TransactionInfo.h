@@ -35,6 +35,7 @@
 #include <QSet>
 
 class Transfer;
+class TransactionStore;
 
 class TransactionInfo : public QObject
 {
@@ -95,7 +96,7 @@ public:
     //! used in tx details popup
     QString destinations_formatted() const;
 private:
-    explicit TransactionInfo(const Monero::TransactionInfo *pimpl, QObject *parent = 0);
+    explicit TransactionInfo(const TransactionStore &store, int row, QObject *parent = 0);
 private:
     friend class TransactionHistory;
     mutable QList<Transfer*> m_transfers;
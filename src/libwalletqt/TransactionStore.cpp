@@ -0,0 +1,374 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "TransactionStore.h"
+
+#include <algorithm>
+#include <set>
+
+#include <wallet/api/wallet2_api.h>
+
+#include <QByteArray>
+
+namespace {
+    // pools are compacted once garbage outgrows live entries by this many elements
+    static const int POOL_GARBAGE_SLACK = 1024;
+}
+
+TransactionStore::TransactionStore()
+    : m_subaddrIndexLive(0)
+    , m_transferLive(0)
+{
+    m_strings.append(QString());
+    m_stringIds.insert(QString(), 0);
+}
+
+int TransactionStore::size() const
+{
+    return m_amount.size();
+}
+
+bool TransactionStore::isEmpty() const
+{
+    return m_amount.isEmpty();
+}
+
+void TransactionStore::clear()
+{
+    *this = TransactionStore();
+}
+
+void TransactionStore::reserve(int rows)
+{
+    m_amount.reserve(rows);
+    m_fee.reserve(rows);
+    m_blockHeight.reserve(rows);
+    m_confirmations.reserve(rows);
+    m_unlockTime.reserve(rows);
+    m_timestamp.reserve(rows);
+    m_hash.reserve(rows);
+    m_subaddrAccount.reserve(rows);
+    m_label.reserve(rows);
+    m_paymentId.reserve(rows);
+    m_description.reserve(rows);
+    m_direction.reserve(rows);
+    m_flags.reserve(rows);
+    m_subaddrIndexOffset.reserve(rows);
+    m_subaddrIndexCount.reserve(rows);
+    m_transferOffset.reserve(rows);
+    m_transferCount.reserve(rows);
+}
+
+void TransactionStore::append(const Monero::TransactionInfo &tx)
+{
+    m_amount.append(0);
+    m_fee.append(0);
+    m_blockHeight.append(0);
+    m_confirmations.append(0);
+    m_unlockTime.append(0);
+    m_timestamp.append(0);
+    m_hash.append(Hash{});
+    m_subaddrAccount.append(0);
+    m_label.append(0);
+    m_paymentId.append(0);
+    m_description.append(0);
+    m_direction.append(0);
+    m_flags.append(0);
+    m_subaddrIndexOffset.append(0);
+    m_subaddrIndexCount.append(0);
+    m_transferOffset.append(0);
+    m_transferCount.append(0);
+    assign(size() - 1, tx);
+}
+
+void TransactionStore::assign(int row, const Monero::TransactionInfo &tx)
+{
+    m_amount[row] = tx.amount();
+    m_fee[row] = tx.fee();
+    m_blockHeight[row] = tx.blockHeight();
+    m_confirmations[row] = tx.confirmations();
+    m_unlockTime[row] = tx.unlockTime();
+    m_timestamp[row] = static_cast<qint64>(tx.timestamp());
+    m_hash[row] = parseHash(tx.hash());
+    m_subaddrAccount[row] = tx.subaddrAccount();
+    m_label[row] = intern(QString::fromStdString(tx.label()));
+    m_paymentId[row] = intern(QString::fromStdString(tx.paymentId()));
+    m_description[row] = intern(QString::fromStdString(tx.description()));
+    m_direction[row] = static_cast<quint8>(tx.direction());
+    m_flags[row] = static_cast<quint8>((tx.isPending() ? Flag_Pending : 0) | (tx.isFailed() ? Flag_Failed : 0) | (tx.isCoinbase() ? Flag_Coinbase : 0));
+
+    // std::set is already ordered
+    const std::set<uint32_t> subaddrIndex = tx.subaddrIndex();
+    m_subaddrIndexLive += static_cast<int>(subaddrIndex.size()) - m_subaddrIndexCount[row];
+    m_subaddrIndexOffset[row] = m_subaddrIndexPool.size();
+    m_subaddrIndexCount[row] = subaddrIndex.size();
+    for (uint32_t index : subaddrIndex) {
+        m_subaddrIndexPool.append(index);
+    }
+
+    const auto &transfers = tx.transfers();
+    m_transferLive += static_cast<int>(transfers.size()) - m_transferCount[row];
+    m_transferOffset[row] = m_transferAmountPool.size();
+    m_transferCount[row] = transfers.size();
+    for (const auto &transfer : transfers) {
+        m_transferAmountPool.append(transfer.amount);
+        m_transferAddressPool.append(intern(QString::fromStdString(transfer.address)));
+    }
+
+    compactPools();
+}
+
+void TransactionStore::remove(int first, int count)
+{
+    for (int row = first; row < first + count; ++row) {
+        m_subaddrIndexLive -= m_subaddrIndexCount[row];
+        m_transferLive -= m_transferCount[row];
+    }
+
+    m_amount.remove(first, count);
+    m_fee.remove(first, count);
+    m_blockHeight.remove(first, count);
+    m_confirmations.remove(first, count);
+    m_unlockTime.remove(first, count);
+    m_timestamp.remove(first, count);
+    m_hash.remove(first, count);
+    m_subaddrAccount.remove(first, count);
+    m_label.remove(first, count);
+    m_paymentId.remove(first, count);
+    m_description.remove(first, count);
+    m_direction.remove(first, count);
+    m_flags.remove(first, count);
+    m_subaddrIndexOffset.remove(first, count);
+    m_subaddrIndexCount.remove(first, count);
+    m_transferOffset.remove(first, count);
+    m_transferCount.remove(first, count);
+
+    compactPools();
+}
+
+bool TransactionStore::sameState(int row, const Monero::TransactionInfo &tx) const
+{
+    const quint8 flags = (tx.isPending() ? Flag_Pending : 0) | (tx.isFailed() ? Flag_Failed : 0) | (tx.isCoinbase() ? Flag_Coinbase : 0);
+    const auto &transfers = tx.transfers();
+    if (m_amount[row] != tx.amount()
+            || m_fee[row] != tx.fee()
+            || m_blockHeight[row] != tx.blockHeight()
+            || m_unlockTime[row] != tx.unlockTime()
+            || m_timestamp[row] != static_cast<qint64>(tx.timestamp())
+            || m_subaddrAccount[row] != tx.subaddrAccount()
+            || m_flags[row] != flags
+            || m_transferCount[row] != static_cast<int>(transfers.size())
+            || !sameString(m_label[row], tx.label())
+            || !sameString(m_paymentId[row], tx.paymentId())
+            || !sameString(m_description[row], tx.description()))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < m_transferCount[row]; ++i) {
+        if (transferAmount(row, i) != transfers[i].amount
+                || !sameString(m_transferAddressPool[m_transferOffset[row] + i], transfers[i].address)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TransactionStore::Hash TransactionStore::parseHash(const std::string &hash)
+{
+    Hash result{};
+    const QByteArray raw = QByteArray::fromHex(QByteArray::fromStdString(hash));
+    std::copy_n(raw.constBegin(), std::min<int>(raw.size(), result.size()), result.begin());
+    return result;
+}
+
+TransactionInfo::Direction TransactionStore::direction(int row) const
+{
+    return static_cast<TransactionInfo::Direction>(m_direction[row]);
+}
+
+bool TransactionStore::isPending(int row) const
+{
+    return m_flags[row] & Flag_Pending;
+}
+
+bool TransactionStore::isFailed(int row) const
+{
+    return m_flags[row] & Flag_Failed;
+}
+
+bool TransactionStore::isCoinbase(int row) const
+{
+    return m_flags[row] & Flag_Coinbase;
+}
+
+quint64 TransactionStore::amount(int row) const
+{
+    return m_amount[row];
+}
+
+quint64 TransactionStore::fee(int row) const
+{
+    return m_fee[row];
+}
+
+quint64 TransactionStore::blockHeight(int row) const
+{
+    return m_blockHeight[row];
+}
+
+quint64 TransactionStore::confirmations(int row) const
+{
+    return m_confirmations[row];
+}
+
+void TransactionStore::setConfirmations(int row, quint64 confirmations)
+{
+    m_confirmations[row] = confirmations;
+}
+
+quint64 TransactionStore::unlockTime(int row) const
+{
+    return m_unlockTime[row];
+}
+
+qint64 TransactionStore::timestamp(int row) const
+{
+    return m_timestamp[row];
+}
+
+const TransactionStore::Hash &TransactionStore::rawHash(int row) const
+{
+    return m_hash[row];
+}
+
+QString TransactionStore::hash(int row) const
+{
+    const Hash &hash = m_hash[row];
+    return QString::fromLatin1(QByteArray::fromRawData(reinterpret_cast<const char *>(hash.data()), hash.size()).toHex());
+}
+
+quint32 TransactionStore::subaddrAccount(int row) const
+{
+    return m_subaddrAccount[row];
+}
+
+int TransactionStore::subaddrIndexCount(int row) const
+{
+    return m_subaddrIndexCount[row];
+}
+
+quint32 TransactionStore::subaddrIndex(int row, int position) const
+{
+    return m_subaddrIndexPool[m_subaddrIndexOffset[row] + position];
+}
+
+QString TransactionStore::label(int row) const
+{
+    return m_strings[m_label[row]];
+}
+
+QString TransactionStore::paymentId(int row) const
+{
+    return m_strings[m_paymentId[row]];
+}
+
+QString TransactionStore::description(int row) const
+{
+    return m_strings[m_description[row]];
+}
+
+int TransactionStore::transferCount(int row) const
+{
+    return m_transferCount[row];
+}
+
+quint64 TransactionStore::transferAmount(int row, int transfer) const
+{
+    return m_transferAmountPool[m_transferOffset[row] + transfer];
+}
+
+QString TransactionStore::transferAddress(int row, int transfer) const
+{
+    return m_strings[m_transferAddressPool[m_transferOffset[row] + transfer]];
+}
+
+quint32 TransactionStore::intern(const QString &value)
+{
+    const auto it = m_stringIds.constFind(value);
+    if (it != m_stringIds.constEnd()) {
+        return it.value();
+    }
+
+    const quint32 id = m_strings.size();
+    m_strings.append(value);
+    m_stringIds.insert(value, id);
+    return id;
+}
+
+bool TransactionStore::sameString(quint32 id, const std::string &value) const
+{
+    if (value.empty()) {
+        return m_strings[id].isEmpty();
+    }
+    return m_strings[id] == QString::fromStdString(value);
+}
+
+void TransactionStore::compactPools()
+{
+    if (m_subaddrIndexPool.size() - m_subaddrIndexLive <= m_subaddrIndexLive + POOL_GARBAGE_SLACK
+            && m_transferAmountPool.size() - m_transferLive <= m_transferLive + POOL_GARBAGE_SLACK) {
+        return;
+    }
+
+    QVector<quint32> subaddrIndexPool;
+    subaddrIndexPool.reserve(m_subaddrIndexLive);
+    QVector<quint64> transferAmountPool;
+    transferAmountPool.reserve(m_transferLive);
+    QVector<quint32> transferAddressPool;
+    transferAddressPool.reserve(m_transferLive);
+
+    for (int row = 0; row < size(); ++row) {
+        const quint32 subaddrIndexOffset = subaddrIndexPool.size();
+        for (int i = 0; i < m_subaddrIndexCount[row]; ++i) {
+            subaddrIndexPool.append(m_subaddrIndexPool[m_subaddrIndexOffset[row] + i]);
+        }
+        m_subaddrIndexOffset[row] = subaddrIndexOffset;
+
+        const quint32 transferOffset = transferAmountPool.size();
+        for (int i = 0; i < m_transferCount[row]; ++i) {
+            transferAmountPool.append(m_transferAmountPool[m_transferOffset[row] + i]);
+            transferAddressPool.append(m_transferAddressPool[m_transferOffset[row] + i]);
+        }
+        m_transferOffset[row] = transferOffset;
+    }
+
+    m_subaddrIndexPool.swap(subaddrIndexPool);
+    m_transferAmountPool.swap(transferAmountPool);
+    m_transferAddressPool.swap(transferAddressPool);
+}
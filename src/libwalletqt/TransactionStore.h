@@ -0,0 +1,150 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef TRANSACTIONSTORE_H
+#define TRANSACTIONSTORE_H
+
+#include <array>
+#include <string>
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "TransactionInfo.h"
+
+namespace Monero {
+struct TransactionInfo;
+}
+
+/**
+ * @brief The TransactionStore class - compact column-wise storage of transaction history rows
+ *
+ * Every field is kept in its own contiguous vector indexed by row. Hashes are stored as raw
+ * 32-byte arrays, timestamps as epoch seconds and strings are interned. Subaddress indices and
+ * transfers are variable-length and live in shared pools referenced by offset and count.
+ *
+ * By the column types, a row takes 110 bytes plus 4 per subaddress index and 12 per transfer,
+ * about 11 MB for 100k rows before vector growth and interned strings. This is computed, not
+ * measured.
+ */
+class TransactionStore
+{
+public:
+    using Hash = std::array<quint8, 32>;
+
+    TransactionStore();
+
+    int size() const;
+    bool isEmpty() const;
+    void clear();
+    void reserve(int rows);
+
+    //! appends a backend transaction
+    void append(const Monero::TransactionInfo &tx);
+    //! overwrites a row with a backend transaction
+    void assign(int row, const Monero::TransactionInfo &tx);
+    void remove(int first, int count);
+
+    //! compares a row with a backend transaction of the same hash, direction and subaddress
+    //! indices, ignoring the confirmation count
+    bool sameState(int row, const Monero::TransactionInfo &tx) const;
+
+    //! parses a hex encoded transaction hash, malformed input yields a zero-padded hash
+    static Hash parseHash(const std::string &hash);
+
+    TransactionInfo::Direction direction(int row) const;
+    bool isPending(int row) const;
+    bool isFailed(int row) const;
+    bool isCoinbase(int row) const;
+    quint64 amount(int row) const;
+    quint64 fee(int row) const;
+    quint64 blockHeight(int row) const;
+    quint64 confirmations(int row) const;
+    void setConfirmations(int row, quint64 confirmations);
+    quint64 unlockTime(int row) const;
+    //! seconds since epoch
+    qint64 timestamp(int row) const;
+    const Hash &rawHash(int row) const;
+    QString hash(int row) const;
+    quint32 subaddrAccount(int row) const;
+    //! subaddress indices are kept sorted
+    int subaddrIndexCount(int row) const;
+    quint32 subaddrIndex(int row, int position) const;
+    QString label(int row) const;
+    QString paymentId(int row) const;
+    QString description(int row) const;
+    int transferCount(int row) const;
+    quint64 transferAmount(int row, int transfer) const;
+    QString transferAddress(int row, int transfer) const;
+
+private:
+    enum Flag : quint8 {
+        Flag_Pending  = 1 << 0,
+        Flag_Failed   = 1 << 1,
+        Flag_Coinbase = 1 << 2
+    };
+
+    quint32 intern(const QString &value);
+    bool sameString(quint32 id, const std::string &value) const;
+    void compactPools();
+
+private:
+    // per-row columns
+    QVector<quint64> m_amount;
+    QVector<quint64> m_fee;
+    QVector<quint64> m_blockHeight;
+    QVector<quint64> m_confirmations;
+    QVector<quint64> m_unlockTime;
+    QVector<qint64> m_timestamp;
+    QVector<Hash> m_hash;
+    QVector<quint32> m_subaddrAccount;
+    QVector<quint32> m_label;
+    QVector<quint32> m_paymentId;
+    QVector<quint32> m_description;
+    QVector<quint8> m_direction;
+    QVector<quint8> m_flags;
+    QVector<quint32> m_subaddrIndexOffset;
+    QVector<quint16> m_subaddrIndexCount;
+    QVector<quint32> m_transferOffset;
+    QVector<quint16> m_transferCount;
+
+    // variable-length pools, rows removed or overwritten leave garbage until compaction
+    QVector<quint32> m_subaddrIndexPool;
+    QVector<quint64> m_transferAmountPool;
+    QVector<quint32> m_transferAddressPool;
+    int m_subaddrIndexLive;
+    int m_transferLive;
+
+    // interned strings, id 0 is the empty string
+    QStringList m_strings;
+    QHash<QString, quint32> m_stringIds;
+};
+
+#endif // TRANSACTIONSTORE_H
@@ -28,6 +28,7 @@
 
 #include "Wallet.h"
 
+#include <algorithm>
 #include <chrono>
 #include <stdexcept>
 #include <string>
@@ -37,14 +38,17 @@
 #include "PendingTransaction.h"
 #include "UnsignedTransaction.h"
 #include "TransactionHistory.h"
+#include "TransactionStore.h"
 #include "AddressBook.h"
 #include "Subaddress.h"
 #include "SubaddressAccount.h"
+#include "ChainNotifier.h"
 #include "model/TransactionHistoryModel.h"
 #include "model/TransactionHistorySortFilterModel.h"
 #include "model/AddressBookModel.h"
 #include "model/SubaddressModel.h"
 #include "model/SubaddressAccountModel.h"
+#include "model/AccountBalanceModel.h"
 #include "wallet/api/wallet2_api.h"
 
 #include <QFile>
@@ -60,9 +64,11 @@
 #include "qt/ScopeGuard.h"
 
 namespace {
-    static const int DAEMON_BLOCKCHAIN_HEIGHT_CACHE_TTL_SECONDS = 5;
-    static const int DAEMON_BLOCKCHAIN_TARGET_HEIGHT_CACHE_TTL_SECONDS = 30;
-    static const int WALLET_CONNECTION_STATUS_CACHE_TTL_SECONDS = 5;
+    static constexpr std::chrono::seconds DAEMON_STATUS_CACHE_TTL{5};
+    // new blocks are pushed by the daemon, the status is only polled to notice it going away
+    static constexpr std::chrono::seconds DAEMON_STATUS_NOTIFIED_CACHE_TTL{30};
+    // how often a waiting store repeats its stop request to a running scan
+    static constexpr int STORE_STOP_RETRY_MS = 50;
 
     static constexpr char ATTRIBUTE_SUBADDRESS_ACCOUNT[] ="gui.subaddress_account";
 }
@@ -98,28 +104,79 @@ NetworkType::Type Wallet::nettype() const
 }
 
 
-void Wallet::updateConnectionStatusAsync()
+std::shared_ptr<const Wallet::DaemonStatus> Wallet::daemonStatus() const
 {
-    m_scheduler.run([this] {
-        qDebug() << "updateConnectionStatusAsync current status:" << m_connectionStatus;
+    return std::atomic_load(&m_daemonStatus);
+}
+
+void Wallet::updateDaemonStatusAsync(bool force)
+{
+    m_scheduler.runKeyed("daemonStatus", [this, force] {
+        pollDaemonStatus(force);
+    });
+}
+
+std::shared_ptr<const Wallet::DaemonStatus> Wallet::pollDaemonStatus(bool force)
+{
+    std::shared_ptr<const DaemonStatus> previous;
+    std::shared_ptr<const DaemonStatus> status;
+    {
+        QMutexLocker locker(&m_daemonStatusMutex);
+
+        previous = daemonStatus();
+        if (!force && std::chrono::steady_clock::now() - previous->polledAt < daemonStatusTtl())
+        {
+            return previous;
+        }
+
+        qDebug() << "Polling daemon status, current status:" << m_connectionStatus;
         if (m_connectionStatus == Wallet::ConnectionStatus_Disconnected)
         {
             setConnectionStatus(ConnectionStatus_Connecting);
         }
-        ConnectionStatus newStatus = static_cast<ConnectionStatus>(m_walletImpl->connected());
-        qDebug() << "Newest wallet status:" << newStatus;
-        if (m_connectionStatus != newStatus)
+
+        auto next = std::make_shared<DaemonStatus>();
+        next->connection = static_cast<ConnectionStatus>(m_walletImpl->connected());
+        if (next->connection == ConnectionStatus_Connected)
         {
-            setConnectionStatus(newStatus);
-            if (newStatus == ConnectionStatus_Connected)
-            {
-                startRefresh();
-            }
+            next->height = m_walletImpl->daemonBlockChainHeight();
+            // Target height is set to 0 if daemon is synced.
+            // Use current height from daemon when target height < current height
+            next->targetHeight = std::max<quint64>(m_walletImpl->daemonBlockChainTargetHeight(), next->height);
+            next->synchronized = next->height > 1 && next->targetHeight <= next->height;
         }
-        // Release lock
-        m_connectionStatusRunning = false;
-        m_connectionStatusTime.restart();
-    });
+        else
+        {
+            // a daemon that can't be reached doesn't make the chain any shorter, nor is it worth two more timeouts
+            next->height = previous->height;
+            next->targetHeight = previous->targetHeight;
+        }
+        next->polledAt = std::chrono::steady_clock::now();
+        qDebug() << "Newest wallet status:" << next->connection;
+
+        status = std::move(next);
+        std::atomic_store(&m_daemonStatus, status);
+    }
+
+    if (m_connectionStatus != status->connection)
+    {
+        setConnectionStatus(status->connection);
+        if (status->connection == ConnectionStatus_Connected)
+        {
+            startRefresh();
+        }
+    }
+    // a new block on the daemon is worth syncing right away rather than on the next interval
+    if (previous->height != 0 && status->height > previous->height)
+    {
+        wakeRefreshThread();
+    }
+    if (status->height != previous->height || status->targetHeight != previous->targetHeight
+            || status->synchronized != previous->synchronized || status->connection != previous->connection)
+    {
+        emit daemonStatusChanged();
+    }
+    return status;
 }
 
 Wallet::ConnectionStatus Wallet::connected(bool forceCheck)
@@ -129,11 +186,10 @@ Wallet::ConnectionStatus Wallet::connected(bool forceCheck)
         return ConnectionStatus_Connecting;
     }
 
-    // cache connection status
-    if (forceCheck || (m_connectionStatusTime.elapsed() / 1000 > m_connectionStatusTtl && !m_connectionStatusRunning) || m_connectionStatusTime.elapsed() > 30000) {
+    if (forceCheck || std::chrono::steady_clock::now() - daemonStatus()->polledAt >= daemonStatusTtl())
+    {
         qDebug() << "Checking connection status";
-        m_connectionStatusRunning = true;
-        updateConnectionStatusAsync();
+        updateDaemonStatusAsync(forceCheck);
     }
 
     return m_connectionStatus;
@@ -184,7 +240,8 @@ QString Wallet::getProxyAddress() const
 
 void Wallet::setProxyAddress(QString address)
 {
-    m_scheduler.run([this, address] {
+    // only the latest address matters, older pending changes are dropped
+    m_scheduler.runKeyed("proxyAddress", [this, address] {
         {
             QMutexLocker locker(&m_proxyMutex);
 
@@ -228,11 +285,10 @@ void Wallet::storeAsync(const QJSValue &callback, const QString &path /* = "" */
 {
     const auto future = m_scheduler.run(
         [this, path] {
-            QMutexLocker locker(&m_asyncMutex);
-
-            return QJSValueList({m_walletImpl->store(path.toStdString())});
+            return QJSValueList({store(path)});
         },
-        callback);
+        callback,
+        FutureScheduler::Lane::Background);
     if (!future.first)
     {
         QJSValue(callback).call(QJSValueList({false}));
@@ -310,7 +366,7 @@ void Wallet::initAsync(
         {
             qCritical() << "Failed to initialize the wallet";
         }
-    });
+    }, FutureScheduler::Lane::Dedicated, FutureScheduler::Priority_Normal, "init");
     if (future.first)
     {
         setConnectionStatus(Wallet::ConnectionStatus_Connecting);
@@ -363,12 +419,12 @@ quint64 Wallet::balance() const
 
 quint64 Wallet::balance(quint32 accountIndex) const
 {
-    return m_walletImpl->balance(accountIndex);
+    return balances()->balance.value(accountIndex);
 }
 
 quint64 Wallet::balanceAll() const
 {
-    return m_walletImpl->balanceAll();
+    return balances()->balanceAll;
 }
 
 quint64 Wallet::unlockedBalance() const
@@ -378,12 +434,84 @@ quint64 Wallet::unlockedBalance() const
 
 quint64 Wallet::unlockedBalance(quint32 accountIndex) const
 {
-    return m_walletImpl->unlockedBalance(accountIndex);
+    return balances()->unlockedBalance.value(accountIndex);
 }
 
 quint64 Wallet::unlockedBalanceAll() const
 {
-    return m_walletImpl->unlockedBalanceAll();
+    return balances()->unlockedBalanceAll;
+}
+
+std::shared_ptr<const Wallet::Balances> Wallet::balances() const
+{
+    return std::atomic_load(&m_balances);
+}
+
+void Wallet::refreshBalancesAsync()
+{
+    // bursts of wallet events collapse into a single recomputation
+    m_scheduler.runKeyed("balances", [this] {
+        auto next = std::make_shared<Balances>();
+        const quint32 accounts = m_walletImpl->numSubaddressAccounts();
+        next->balance.reserve(accounts);
+        next->unlockedBalance.reserve(accounts);
+        for (quint32 accountIndex = 0; accountIndex < accounts; ++accountIndex)
+        {
+            next->balance.append(m_walletImpl->balance(accountIndex));
+            next->unlockedBalance.append(m_walletImpl->unlockedBalance(accountIndex));
+            next->balanceAll += next->balance.last();
+            next->unlockedBalanceAll += next->unlockedBalance.last();
+        }
+
+        const std::shared_ptr<const Balances> previous = balances();
+        if (previous->balance == next->balance && previous->unlockedBalance == next->unlockedBalance)
+        {
+            return;
+        }
+        std::atomic_store(&m_balances, std::shared_ptr<const Balances>(std::move(next)));
+        emit balanceChanged();
+    }, FutureScheduler::Lane::Background, FutureScheduler::Priority_High);
+}
+
+void Wallet::refreshSubaddressesAsync()
+{
+    const quint32 accountIndex = currentSubaddressAccount();
+    // bursts of refreshes collapse into a single rebuild
+    m_scheduler.runKeyed("subaddresses", [this, accountIndex] {
+        std::shared_ptr<const Subaddress::Rows> subaddresses;
+        SubaddressAccount::Snapshot accounts;
+        runRebuild(SyncMetrics::Phase_Subaddress, [this, accountIndex, &subaddresses] {
+            subaddresses = m_subaddress->load(accountIndex);
+        });
+        runRebuild(SyncMetrics::Phase_SubaddressAccount, [this, &accounts] {
+            accounts = m_subaddressAccount->load();
+        });
+        {
+            QMutexLocker locker(&m_subaddressesBuiltMutex);
+            m_publishSubaddresses = [this, accountIndex, subaddresses, accounts] {
+                // an account switch in the meantime already loaded the rows of the new account
+                if (accountIndex == m_currentSubaddressAccount)
+                {
+                    m_subaddress->publish(subaddresses);
+                }
+                m_subaddressAccount->publish(accounts);
+            };
+        }
+        emit subaddressesBuilt();
+    }, FutureScheduler::Lane::Dedicated);
+}
+
+void Wallet::onSubaddressesBuilt()
+{
+    std::function<void ()> publish;
+    {
+        QMutexLocker locker(&m_subaddressesBuiltMutex);
+        publish.swap(m_publishSubaddresses);
+    }
+    if (publish)
+    {
+        publish();
+    }
 }
 
 quint32 Wallet::currentSubaddressAccount() const
@@ -400,13 +528,15 @@ void Wallet::switchSubaddressAccount(quint32 accountIndex)
             qWarning() << "failed to set " << ATTRIBUTE_SUBADDRESS_ACCOUNT << " cache attribute";
         }
         m_subaddress->refresh(m_currentSubaddressAccount);
-        m_history->refresh(m_currentSubaddressAccount);
+        m_history->showAccount(m_currentSubaddressAccount);
         emit currentSubaddressAccountChanged();
+        emit balanceChanged();
     }
 }
 void Wallet::addSubaddressAccount(const QString& label)
 {
     m_walletImpl->addSubaddressAccount(label.toStdString());
+    refreshBalancesAsync();
     switchSubaddressAccount(numSubaddressAccounts() - 1);
 }
 quint32 Wallet::numSubaddressAccounts() const
@@ -428,6 +558,9 @@ QString Wallet::getSubaddressLabel(quint32 accountIndex, quint32 addressIndex) c
 void Wallet::setSubaddressLabel(quint32 accountIndex, quint32 addressIndex, const QString &label)
 {
     m_walletImpl->setSubaddressLabel(accountIndex, addressIndex, label.toStdString());
+    if (m_historySortFilterModel) {
+        m_historySortFilterModel->invalidateAnnotations();
+    }
     emit currentSubaddressAccountChanged();
 }
 void Wallet::deviceShowAddressAsync(quint32 accountIndex, quint32 addressIndex, const QString &paymentId)
@@ -435,35 +568,17 @@ void Wallet::deviceShowAddressAsync(quint32 accountIndex, quint32 addressIndex,
     m_scheduler.run([this, accountIndex, addressIndex, paymentId] {
         m_walletImpl->deviceShowAddress(accountIndex, addressIndex, paymentId.toStdString());
         emit deviceShowAddressShowed();
-    });
+    }, FutureScheduler::Lane::Dedicated);
 }
 
 void Wallet::refreshHeightAsync()
 {
-    m_scheduler.run([this] {
-        quint64 daemonHeight;
-        QPair<bool, QFuture<void>> daemonHeightFuture = m_scheduler.run([this, &daemonHeight] {
-            daemonHeight = daemonBlockChainHeight();
-        });
-        if (!daemonHeightFuture.first)
-        {
-            return;
-        }
+    m_scheduler.runKeyed("refreshHeight", [this] {
+        // both heights come from the same snapshot, polled only if it went stale
+        const std::shared_ptr<const DaemonStatus> status = pollDaemonStatus(false);
+        const quint64 walletHeight = blockChainHeight();
 
-        quint64 targetHeight;
-        QPair<bool, QFuture<void>> targetHeightFuture = m_scheduler.run([this, &targetHeight] {
-            targetHeight = daemonBlockChainTargetHeight();
-        });
-        if (!targetHeightFuture.first)
-        {
-            return;
-        }
-
-        quint64 walletHeight = blockChainHeight();
-        daemonHeightFuture.second.waitForFinished();
-        targetHeightFuture.second.waitForFinished();
-
-        emit heightRefreshed(walletHeight, daemonHeight, targetHeight);
+        emit heightRefreshed(walletHeight, status->height, status->targetHeight);
     });
 }
 
@@ -474,31 +589,17 @@ quint64 Wallet::blockChainHeight() const
 
 quint64 Wallet::daemonBlockChainHeight() const
 {
-    // cache daemon blockchain height for some time (60 seconds by default)
-
-    if (m_daemonBlockChainHeight == 0
-            || m_daemonBlockChainHeightTime.elapsed() / 1000 > m_daemonBlockChainHeightTtl) {
-        m_daemonBlockChainHeight = m_walletImpl->daemonBlockChainHeight();
-        m_daemonBlockChainHeightTime.restart();
-    }
-    return m_daemonBlockChainHeight;
+    return daemonStatus()->height;
 }
 
 quint64 Wallet::daemonBlockChainTargetHeight() const
 {
-    if (m_daemonBlockChainTargetHeight <= 1
-            || m_daemonBlockChainTargetHeightTime.elapsed() / 1000 > m_daemonBlockChainTargetHeightTtl) {
-        m_daemonBlockChainTargetHeight = m_walletImpl->daemonBlockChainTargetHeight();
-
-        // Target height is set to 0 if daemon is synced.
-        // Use current height from daemon when target height < current height
-        if (m_daemonBlockChainTargetHeight < m_daemonBlockChainHeight){
-            m_daemonBlockChainTargetHeight = m_daemonBlockChainHeight;
-        }
-        m_daemonBlockChainTargetHeightTime.restart();
-    }
+    return daemonStatus()->targetHeight;
+}
 
-    return m_daemonBlockChainTargetHeight;
+bool Wallet::daemonSynchronized() const
+{
+    return daemonStatus()->synchronized;
 }
 
 bool Wallet::exportKeyImages(const QString& path, bool all)
@@ -536,32 +637,209 @@ bool Wallet::refresh(bool historyAndSubaddresses /* = true */)
         refreshingSet(false);
     });
 
+    SyncMetrics::Sample sample;
+    QElapsedTimer total;
+    total.start();
+    QElapsedTimer phase;
+    bool result;
+    quint64 heightAfter;
     {
-        QMutexLocker locker(&m_asyncMutex);
+        QMutexLocker locker(&m_scanMutex);
+        sample.lockWaitMs = total.elapsed();
 
-        bool result = m_walletImpl->refresh();
-        if (historyAndSubaddresses)
+        // a waiting store or rebuild goes first, it asks for another refresh once it is done
+        m_scanning = true;
+        const auto scanning = sg::make_scope_guard([this]() noexcept {
+            m_scanning = false;
+        });
+        if (m_storePending)
         {
-            m_history->refresh(currentSubaddressAccount());
-            m_subaddress->refresh(currentSubaddressAccount());
-            m_subaddressAccount->getAll();
+            return false;
         }
-        if (result)
-            emit updated();
-        return result;
+        if (m_rebuildsWaiting > 0)
+        {
+            m_scanYielded = true;
+            return false;
+        }
+
+        const quint64 heightBefore = m_walletImpl->blockChainHeight();
+        phase.start();
+        result = m_walletImpl->refresh();
+        sample.walletMs = phase.restart();
+        heightAfter = m_walletImpl->blockChainHeight();
+        sample.blocksScanned = heightAfter > heightBefore ? heightAfter - heightBefore : 0;
+    }
+
+    // rebuilt on workers once the scan lock is free, see runRebuild(), only the results are
+    // swapped in on the GUI thread
+    if (historyAndSubaddresses)
+    {
+        m_history->refreshAsync(currentSubaddressAccount());
+        refreshSubaddressesAsync();
+    }
+    sample.totalMs = total.elapsed();
+    recordSyncMetrics(sample, heightAfter);
+    if (result)
+        emit updated();
+    return result;
+}
+
+bool Wallet::store(const QString &path)
+{
+    QMutexLocker storeLocker(&m_storeMutex);
+
+    // stop a running scan at its next block batch rather than waiting for the whole sync,
+    // wallet2 keeps everything scanned up to that point
+    m_storePending = true;
+    // a stop that lands before wallet2 has started its scan loop is lost, so it's repeated
+    // until the scan gives the lock up
+    bool interrupted = false;
+    while (true)
+    {
+        if (m_scanning)
+        {
+            m_walletImpl->stop();
+            interrupted = true;
+        }
+        if (m_scanMutex.tryLock(STORE_STOP_RETRY_MS))
+        {
+            break;
+        }
+    }
+
+    bool result;
+    {
+        const auto scanUnlock = sg::make_scope_guard([this]() noexcept {
+            m_scanMutex.unlock();
+        });
+        m_storePending = false;
+
+        result = m_walletImpl->store(path.toStdString());
+    }
+
+    if (interrupted)
+    {
+        QMutexLocker locker(&m_refreshMutex);
+        m_refreshNow = true;
+        m_refreshCondition.wakeAll();
+    }
+    return result;
+}
+
+void Wallet::recordSyncMetrics(const SyncMetrics::Sample &sample, quint64 walletHeight)
+{
+    // cached heights only, the refresh path must not wait on extra daemon requests
+    const quint64 targetHeight = daemonStatus()->targetHeight;
+    const quint64 remainingBlocks = targetHeight > walletHeight ? targetHeight - walletHeight : 0;
+    const SyncMetrics::Summary summary = m_syncMetrics.record(sample, remainingBlocks);
+
+    if (m_syncMetricsLogInterval > 0)
+    {
+        QMutexLocker locker(&m_syncMetricsLogMutex);
+        if (!m_syncMetricsLogTime.isValid() || m_syncMetricsLogTime.elapsed() / 1000 >= m_syncMetricsLogInterval)
+        {
+            qInfo() << "Sync metrics:" << summary.toString();
+            m_syncMetricsLogTime.restart();
+        }
+    }
+
+    emit syncMetricsChanged();
+}
+
+void Wallet::runRebuild(SyncMetrics::Phase phase, const std::function<void ()> &rebuild)
+{
+    // the history and subaddress backends read wallet2's transfers, which a scan modifies
+    {
+        ++m_rebuildsWaiting;
+        QMutexLocker locker(&m_scanMutex);
+        --m_rebuildsWaiting;
+
+        QElapsedTimer timer;
+        timer.start();
+        rebuild();
+        m_syncMetrics.recordPhase(phase, timer.elapsed());
+    }
+    emit syncMetricsChanged();
+
+    if (m_scanYielded.exchange(false))
+    {
+        QMutexLocker locker(&m_refreshMutex);
+        m_refreshNow = true;
+        m_refreshCondition.wakeAll();
+    }
+}
+
+quint64 Wallet::syncBlocksScanned() const
+{
+    return m_syncMetrics.summary().lastBlocksScanned;
+}
+
+double Wallet::syncBlocksPerSecond() const
+{
+    return m_syncMetrics.summary().blocksPerSecond;
+}
+
+double Wallet::syncRefreshMs() const
+{
+    return m_syncMetrics.summary().totalMs;
+}
+
+double Wallet::syncLockWaitMs() const
+{
+    return m_syncMetrics.summary().lockWaitMs;
+}
+
+double Wallet::syncWalletMs() const
+{
+    return m_syncMetrics.summary().walletMs;
+}
+
+double Wallet::syncHistoryMs() const
+{
+    return m_syncMetrics.summary().historyMs;
+}
+
+double Wallet::syncSubaddressMs() const
+{
+    return m_syncMetrics.summary().subaddressMs;
+}
+
+double Wallet::syncSubaddressAccountMs() const
+{
+    return m_syncMetrics.summary().subaddressAccountMs;
+}
+
+qint64 Wallet::syncEtaSeconds() const
+{
+    return m_syncMetrics.summary().etaSeconds;
+}
+
+int Wallet::syncMetricsLogInterval() const
+{
+    return m_syncMetricsLogInterval;
+}
+
+void Wallet::setSyncMetricsLogInterval(int seconds)
+{
+    if (m_syncMetricsLogInterval.exchange(seconds) != seconds)
+    {
+        emit syncMetricsLogIntervalChanged();
     }
 }
 
 void Wallet::startRefresh()
 {
     qDebug() << "Starting refresh";
+    QMutexLocker locker(&m_refreshMutex);
     m_refreshEnabled = true;
     m_refreshNow = true;
+    m_refreshCondition.wakeAll();
 }
 
 void Wallet::pauseRefresh()
 {
     qDebug() << "Pausing refresh";
+    QMutexLocker locker(&m_refreshMutex);
     m_refreshEnabled = false;
 }
 
@@ -600,10 +878,20 @@ void Wallet::createTransactionAsync(
     quint32 mixin_count,
     PendingTransaction::Priority priority)
 {
-    m_scheduler.run([this, destinationAddresses, payment_id, destinationAmounts, mixin_count, priority] {
+    m_createTransactionToken.cancel();
+    m_createTransactionToken = m_scheduler.run([this, destinationAddresses, payment_id, destinationAmounts, mixin_count, priority] {
+        if (FutureScheduler::cancelled())
+        {
+            return;
+        }
         PendingTransaction *tx = createTransaction(destinationAddresses, payment_id, destinationAmounts, mixin_count, priority);
+        if (FutureScheduler::cancelled())
+        {
+            disposeTransaction(tx);
+            return;
+        }
         emit transactionCreated(tx, destinationAddresses, payment_id, mixin_count);
-    });
+    }, FutureScheduler::Lane::Interactive, FutureScheduler::Priority_High, "createTransaction").token;
 }
 
 PendingTransaction *Wallet::createTransactionAll(const QString &dst_addr, const QString &payment_id,
@@ -621,10 +909,20 @@ void Wallet::createTransactionAllAsync(const QString &dst_addr, const QString &p
                                quint32 mixin_count,
                                PendingTransaction::Priority priority)
 {
-    m_scheduler.run([this, dst_addr, payment_id, mixin_count, priority] {
+    m_createTransactionToken.cancel();
+    m_createTransactionToken = m_scheduler.run([this, dst_addr, payment_id, mixin_count, priority] {
+        if (FutureScheduler::cancelled())
+        {
+            return;
+        }
         PendingTransaction *tx = createTransactionAll(dst_addr, payment_id, mixin_count, priority);
+        if (FutureScheduler::cancelled())
+        {
+            disposeTransaction(tx);
+            return;
+        }
         emit transactionCreated(tx, {dst_addr}, payment_id, mixin_count);
-    });
+    }, FutureScheduler::Lane::Interactive, FutureScheduler::Priority_High, "createTransaction").token;
 }
 
 PendingTransaction *Wallet::createSweepUnmixableTransaction()
@@ -636,10 +934,25 @@ PendingTransaction *Wallet::createSweepUnmixableTransaction()
 
 void Wallet::createSweepUnmixableTransactionAsync()
 {
-    m_scheduler.run([this] {
+    m_createTransactionToken.cancel();
+    m_createTransactionToken = m_scheduler.run([this] {
+        if (FutureScheduler::cancelled())
+        {
+            return;
+        }
         PendingTransaction *tx = createSweepUnmixableTransaction();
+        if (FutureScheduler::cancelled())
+        {
+            disposeTransaction(tx);
+            return;
+        }
         emit transactionCreated(tx, {""}, "", 0);
-    });
+    }, FutureScheduler::Lane::Interactive, FutureScheduler::Priority_High, "createTransaction").token;
+}
+
+void Wallet::cancelCreateTransaction()
+{
+    m_createTransactionToken.cancel();
 }
 
 UnsignedTransaction * Wallet::loadTxFile(const QString &fileName)
@@ -664,7 +977,7 @@ void Wallet::commitTransactionAsync(PendingTransaction *t)
     m_scheduler.run([this, t] {
         auto txIdList = t->txid();  // retrieve before commit
         emit transactionCommitted(t->commit(), t, txIdList);
-    });
+    }, FutureScheduler::Lane::Interactive, FutureScheduler::Priority_High, "commitTransaction");
 }
 
 void Wallet::disposeTransaction(PendingTransaction *t)
@@ -684,9 +997,11 @@ void Wallet::estimateTransactionFeeAsync(
     PendingTransaction::Priority priority,
     const QJSValue &callback)
 {
-    m_scheduler.run(
+    // a newer estimate supersedes the previous one, its callback is never called
+    m_feeEstimateToken.cancel();
+    m_feeEstimateToken = m_scheduler.run(
         [this, destinationAddresses, amounts, priority] {
-            if (destinationAddresses.size() != amounts.size())
+            if (destinationAddresses.size() != amounts.size() || FutureScheduler::cancelled())
             {
                 return QJSValueList({""});
             }
@@ -703,7 +1018,10 @@ void Wallet::estimateTransactionFeeAsync(
                 static_cast<Monero::PendingTransaction::Priority>(priority));
             return QJSValueList({QString::fromStdString(Monero::Wallet::displayAmount(fee))});
         },
-        callback);
+        callback,
+        FutureScheduler::Lane::Interactive,
+        FutureScheduler::Priority_Normal,
+        "estimateTransactionFee").token;
 }
 
 TransactionHistory *Wallet::history() const
@@ -721,6 +1039,25 @@ TransactionHistorySortFilterModel *Wallet::historyModel() const
         m_historySortFilterModel->setSourceModel(m_historyModel);
         m_historySortFilterModel->setSortRole(TransactionHistoryModel::TransactionBlockHeightRole);
         m_historySortFilterModel->sort(0, Qt::DescendingOrder);
+        // the history page searches notes, contact names and receiving addresses too
+        m_historySortFilterModel->setSearchAnnotator([w](const TransactionStore &txs, int row) {
+            QStringList fields;
+            fields.append(w->getUserNote(txs.hash(row)));
+            if (txs.direction(row) == TransactionInfo::Direction_Out) {
+                for (int i = 0; i < txs.transferCount(row); ++i) {
+                    fields.append(w->m_addressBook->getDescription(txs.transferAddress(row, i)));
+                }
+            } else {
+                for (int i = 0; i < txs.subaddrIndexCount(row); ++i) {
+                    const quint32 index = txs.subaddrIndex(row, i);
+                    fields.append(w->address(txs.subaddrAccount(row), index));
+                    fields.append(w->getSubaddressLabel(txs.subaddrAccount(row), index));
+                }
+            }
+            return fields;
+        });
+        connect(m_addressBook, &AddressBook::refreshFinished,
+                m_historySortFilterModel, &TransactionHistorySortFilterModel::invalidateAnnotations);
     }
 
     return m_historySortFilterModel;
@@ -769,6 +1106,15 @@ SubaddressAccountModel *Wallet::subaddressAccountModel() const
     return m_subaddressAccountModel;
 }
 
+AccountBalanceModel *Wallet::balanceModel() const
+{
+    if (!m_balanceModel) {
+        Wallet * w = const_cast<Wallet*>(this);
+        m_balanceModel = new AccountBalanceModel(w);
+    }
+    return m_balanceModel;
+}
+
 QString Wallet::generatePaymentId() const
 {
     return QString::fromStdString(Monero::Wallet::genPaymentId());
@@ -790,7 +1136,11 @@ bool Wallet::setCacheAttribute(const QString &key, const QString &val)
 
 bool Wallet::setUserNote(const QString &txid, const QString &note)
 {
-  return m_walletImpl->setUserNote(txid.toStdString(), note.toStdString());
+  const bool result = m_walletImpl->setUserNote(txid.toStdString(), note.toStdString());
+  if (result && m_historySortFilterModel) {
+    m_historySortFilterModel->invalidateAnnotations();
+  }
+  return result;
 }
 
 QString Wallet::getUserNote(const QString &txid) const
@@ -807,7 +1157,7 @@ void Wallet::getTxKeyAsync(const QString &txid, const QJSValue &callback)
 {
     m_scheduler.run([this, txid] {
         return QJSValueList({txid, getTxKey(txid)});
-    }, callback);
+    }, callback, FutureScheduler::Lane::Background, FutureScheduler::Priority_Normal, "txKey");
 }
 
 QString Wallet::checkTxKey(const QString &txid, const QString &tx_key, const QString &address)
@@ -828,11 +1178,12 @@ QString Wallet::getTxProof(const QString &txid, const QString &address, const QS
     return QString::fromStdString(result);
 }
 
+// proofs take a while on big wallets, they stay off the lane of the short UI queries
 void Wallet::getTxProofAsync(const QString &txid, const QString &address, const QString &message, const QJSValue &callback)
 {
     m_scheduler.run([this, txid, address, message] {
         return QJSValueList({txid, getTxProof(txid, address, message)});
-    }, callback);
+    }, callback, FutureScheduler::Lane::Background, FutureScheduler::Priority_Normal, "txProof");
 }
 
 QString Wallet::checkTxProof(const QString &txid, const QString &address, const QString &message, const QString &signature)
@@ -858,7 +1209,7 @@ void Wallet::getSpendProofAsync(const QString &txid, const QString &message, con
 {
     m_scheduler.run([this, txid, message] {
         return QJSValueList({txid, getSpendProof(txid, message)});
-    }, callback);
+    }, callback, FutureScheduler::Lane::Background, FutureScheduler::Priority_Normal, "spendProof");
 }
 
 Q_INVOKABLE QString Wallet::checkSpendProof(const QString &txid, const QString &message, const QString &signature) const
@@ -985,7 +1336,7 @@ QString Wallet::make_uri(const QString &address, const quint64 &amount, const QS
 
 bool Wallet::rescanSpent()
 {
-    QMutexLocker locker(&m_asyncMutex);
+    QMutexLocker locker(&m_scanMutex);
 
     return m_walletImpl->rescanSpent();
 }
@@ -1100,38 +1451,62 @@ Wallet::Wallet(Monero::Wallet *w, QObject *parent)
     , m_walletImpl(w)
     , m_history(new TransactionHistory(m_walletImpl->history(), this))
     , m_historyModel(nullptr)
+    , m_historySortFilterModel(nullptr)
     , m_addressBook(new AddressBook(m_walletImpl->addressBook(), this))
     , m_addressBookModel(nullptr)
-    , m_daemonBlockChainHeight(0)
-    , m_daemonBlockChainHeightTtl(DAEMON_BLOCKCHAIN_HEIGHT_CACHE_TTL_SECONDS)
-    , m_daemonBlockChainTargetHeight(0)
-    , m_daemonBlockChainTargetHeightTtl(DAEMON_BLOCKCHAIN_TARGET_HEIGHT_CACHE_TTL_SECONDS)
+    , m_daemonStatus(std::make_shared<const DaemonStatus>())
     , m_connectionStatus(Wallet::ConnectionStatus_Disconnected)
-    , m_connectionStatusTtl(WALLET_CONNECTION_STATUS_CACHE_TTL_SECONDS)
     , m_disconnected(true)
     , m_initialized(false)
     , m_initializing(false)
     , m_currentSubaddressAccount(0)
     , m_subaddress(new Subaddress(m_walletImpl->subaddress(), this))
     , m_subaddressModel(nullptr)
-    , m_subaddressAccount(new SubaddressAccount(m_walletImpl->subaddressAccount(), this))
+    , m_subaddressAccount(new SubaddressAccount(m_walletImpl->subaddressAccount(), m_walletImpl, m_history, this))
     , m_subaddressAccountModel(nullptr)
+    , m_balances(std::make_shared<const Balances>())
+    , m_balanceModel(nullptr)
+    , m_scanning(false)
+    , m_storePending(false)
+    , m_rebuildsWaiting(0)
+    , m_scanYielded(false)
+    , m_refreshPolicy(new AdaptiveRefreshPolicy())
+    , m_refreshDecision{std::chrono::milliseconds::zero(), QString()}
     , m_refreshNow(false)
+    , m_refreshReschedule(false)
+    , m_daemonHeightChanged(false)
+    , m_poolChanged(false)
+    , m_windowVisible(true)
+    , m_idleSeconds(0)
     , m_refreshEnabled(false)
+    , m_refreshStopping(false)
+    , m_chainNotifier(new ChainNotifier(this))
+    , m_syncMetricsLogInterval(0)
     , m_refreshing(false)
     , m_scheduler(this)
 {
     m_walletListener = new WalletListenerImpl(this);
     m_walletImpl->setListener(m_walletListener);
     m_currentSubaddressAccount = getCacheAttribute(ATTRIBUTE_SUBADDRESS_ACCOUNT).toUInt();
-    // start cache timers
-    m_connectionStatusTime.start();
-    m_daemonBlockChainHeightTime.start();
-    m_daemonBlockChainTargetHeightTime.start();
-    m_connectionStatusRunning = false;
     m_daemonUsername = "";
     m_daemonPassword = "";
 
+    // handled on the notifier's thread, both only flag the refresh thread and the scheduler
+    connect(m_chainNotifier, &ChainNotifier::newBlock, this, &Wallet::onChainBlock, Qt::DirectConnection);
+    connect(m_chainNotifier, &ChainNotifier::txPoolAdded, this, &Wallet::onTxPoolAdded, Qt::DirectConnection);
+
+    connect(this, &Wallet::subaddressesBuilt, this, &Wallet::onSubaddressesBuilt, Qt::QueuedConnection);
+    m_history->m_runBuild = [this](const std::function<void ()> &build) {
+        runRebuild(SyncMetrics::Phase_History, build);
+    };
+    connect(this, &Wallet::updated, this, &Wallet::refreshBalancesAsync);
+    connect(this, &Wallet::refreshed, this, &Wallet::refreshBalancesAsync);
+    connect(this, &Wallet::moneyReceived, this, &Wallet::refreshBalancesAsync);
+    connect(this, &Wallet::moneySpent, this, &Wallet::refreshBalancesAsync);
+    connect(this, &Wallet::unconfirmedMoneyReceived, this, &Wallet::refreshBalancesAsync);
+    connect(this, &Wallet::transactionCommitted, this, &Wallet::refreshBalancesAsync);
+    refreshBalancesAsync();
+
     startRefreshThread();
 }
 
@@ -1139,9 +1514,17 @@ Wallet::~Wallet()
 {
     qDebug("~Wallet: Closing wallet");
 
+    // the notifier calls into the refresh thread and the scheduler, it goes first
+    m_chainNotifier->setAddress(QString());
     pauseRefresh();
     m_walletImpl->stop();
+    stopRefreshThread();
     m_scheduler.shutdownWaitForFinished();
+    // the search workers call back into the wallet
+    if (m_historySortFilterModel) {
+        m_historySortFilterModel->shutdown();
+    }
+    m_history->shutdown();
 
     //Monero::WalletManagerFactory::getWalletManager()->closeWallet(m_walletImpl);
     if(status() == Status_Critical)
@@ -1159,30 +1542,179 @@ Wallet::~Wallet()
 
 void Wallet::startRefreshThread()
 {
-    const auto future = m_scheduler.run([this] {
-        constexpr const std::chrono::seconds refreshInterval{10};
-        constexpr const std::chrono::milliseconds intervalResolution{100};
+    m_refreshThread = std::thread([this] {
+        quint64 walletHeight = 0;
+        quint64 daemonHeight = 0;
+        bool connected = false;
+        int stalledRefreshes = 0;
 
+        QMutexLocker locker(&m_refreshMutex);
         auto last = std::chrono::steady_clock::now();
-        while (!m_scheduler.stopping())
+        auto due = last;
+        while (!m_refreshStopping)
         {
-            if (m_refreshEnabled)
+            if (!m_refreshEnabled)
             {
-                const auto now = std::chrono::steady_clock::now();
-                const auto elapsed = now - last;
-                if (elapsed >= refreshInterval || m_refreshNow)
-                {
-                    refresh(false);
-                    last = std::chrono::steady_clock::now();
-                    m_refreshNow = false;
-                }
+                m_refreshCondition.wait(&m_refreshMutex);
+                continue;
             }
 
-            std::this_thread::sleep_for(intervalResolution);
+            const auto now = std::chrono::steady_clock::now();
+            if (m_refreshReschedule)
+            {
+                m_refreshReschedule = false;
+                const RefreshState state{walletHeight, daemonHeight, connected, stalledRefreshes == 0, stalledRefreshes,
+                                         m_daemonHeightChanged, m_poolChanged, m_chainNotifier->live(),
+                                         m_windowVisible, m_idleSeconds};
+                m_refreshDecision = m_refreshPolicy->next(state);
+                due = (m_daemonHeightChanged ? now : last) + m_refreshDecision.delay;
+
+                locker.unlock();
+                emit refreshScheduleChanged();
+                locker.relock();
+                continue;
+            }
+
+            if (!m_refreshNow && now < due)
+            {
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(due - now);
+                m_refreshCondition.wait(&m_refreshMutex, static_cast<unsigned long>(remaining.count()) + 1);
+                continue;
+            }
+
+            m_refreshNow = false;
+            locker.unlock();
+            const bool refreshed = refresh(false);
+            const quint64 previousHeight = walletHeight;
+            walletHeight = blockChainHeight();
+            // the refresh thread is the status' regular schedule, a fresh snapshot is reused as is
+            const std::shared_ptr<const DaemonStatus> status = pollDaemonStatus(false);
+            daemonHeight = status->height;
+            connected = status->connection == ConnectionStatus_Connected;
+            stalledRefreshes = refreshed && walletHeight > previousHeight ? 0 : stalledRefreshes + 1;
+            locker.relock();
+            // the refresh above already caught up with any height and pool change seen so far
+            m_daemonHeightChanged = false;
+            m_poolChanged = false;
+            m_refreshReschedule = true;
+            last = std::chrono::steady_clock::now();
         }
     });
-    if (!future.first)
+}
+
+void Wallet::stopRefreshThread()
+{
+    {
+        QMutexLocker locker(&m_refreshMutex);
+        m_refreshStopping = true;
+        m_refreshCondition.wakeAll();
+    }
+    if (m_refreshThread.joinable())
+    {
+        m_refreshThread.join();
+    }
+}
+
+void Wallet::wakeRefreshThread() const
+{
+    QMutexLocker locker(&m_refreshMutex);
+    m_daemonHeightChanged = true;
+    m_refreshReschedule = true;
+    m_refreshCondition.wakeAll();
+}
+
+QString Wallet::refreshPolicy() const
+{
+    QMutexLocker locker(&m_refreshMutex);
+    return m_refreshPolicy->name();
+}
+
+void Wallet::setRefreshPolicy(const QString &name)
+{
+    std::unique_ptr<RefreshPolicy> policy = RefreshPolicy::create(name);
+    if (!policy)
+    {
+        qWarning() << "Unknown refresh policy" << name;
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_refreshMutex);
+        if (m_refreshPolicy->name() == policy->name())
+        {
+            return;
+        }
+        m_refreshPolicy = std::move(policy);
+        m_refreshReschedule = true;
+        m_refreshCondition.wakeAll();
+    }
+    emit refreshPolicyChanged();
+}
+
+int Wallet::refreshDelay() const
+{
+    QMutexLocker locker(&m_refreshMutex);
+    return static_cast<int>(m_refreshDecision.delay.count());
+}
+
+QString Wallet::refreshReason() const
+{
+    QMutexLocker locker(&m_refreshMutex);
+    return m_refreshDecision.reason;
+}
+
+QString Wallet::chainNotificationAddress() const
+{
+    return m_chainNotifier->address();
+}
+
+void Wallet::setChainNotificationAddress(const QString &address)
+{
+    if (m_chainNotifier->address() == address)
+    {
+        return;
+    }
+    m_chainNotifier->setAddress(address);
+    emit chainNotificationAddressChanged();
+}
+
+std::chrono::seconds Wallet::daemonStatusTtl() const
+{
+    return m_chainNotifier->live() ? DAEMON_STATUS_NOTIFIED_CACHE_TTL : DAEMON_STATUS_CACHE_TTL;
+}
+
+void Wallet::onChainBlock(quint64 height)
+{
+    qDebug() << "Daemon announced height" << height;
+    // the status poll publishes the new height, the refresh thread starts right away
+    updateDaemonStatusAsync(true);
+    wakeRefreshThread();
+}
+
+void Wallet::onTxPoolAdded()
+{
+    QMutexLocker locker(&m_refreshMutex);
+    // pool transactions are picked up by the next refresh, bursts are spread over the policy's delay
+    if (!m_poolChanged)
+    {
+        m_poolChanged = true;
+        m_refreshReschedule = true;
+        m_refreshCondition.wakeAll();
+    }
+}
+
+void Wallet::setUserActivity(bool windowVisible, int idleSeconds)
+{
+    QMutexLocker locker(&m_refreshMutex);
+    const bool notified = m_chainNotifier->live();
+    const RefreshState before{0, 0, true, true, 0, false, false, notified, m_windowVisible, m_idleSeconds};
+    const RefreshState after{0, 0, true, true, 0, false, false, notified, windowVisible, idleSeconds};
+    m_windowVisible = windowVisible;
+    m_idleSeconds = idleSeconds;
+    // only wake the refresh thread if the policy would decide differently
+    if (m_refreshPolicy->next(before).reason != m_refreshPolicy->next(after).reason)
     {
-        throw std::runtime_error("failed to start auto refresh thread");
+        m_refreshReschedule = true;
+        m_refreshCondition.wakeAll();
     }
 }
@@ -30,16 +30,23 @@
 #define WALLET_H
 
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
 
 #include <QElapsedTimer>
 #include <QObject>
 #include <QMutex>
+#include <QWaitCondition>
 #include <QList>
+#include <QVector>
 #include <QJSValue>
 #include <QtConcurrent/QtConcurrent>
 
 #include "wallet/api/wallet2_api.h" // we need to have an access to the Monero::Wallet::Status enum here;
 #include "qt/FutureScheduler.h"
+#include "RefreshPolicy.h"
+#include "SyncMetrics.h"
 #include "PendingTransaction.h" // we need to have an access to the PendingTransaction::Priority enum here;
 #include "UnsignedTransaction.h"
 #include "NetworkType.h"
@@ -60,6 +67,8 @@ class Subaddress;
 class SubaddressModel;
 class SubaddressAccount;
 class SubaddressAccountModel;
+class AccountBalanceModel;
+class ChainNotifier;
 
 class Wallet : public QObject, public PassprasePrompter
 {
@@ -73,6 +82,9 @@ class Wallet : public QObject, public PassprasePrompter
 //    Q_PROPERTY(ConnectionStatus connected READ connected)
     Q_PROPERTY(quint32 currentSubaddressAccount READ currentSubaddressAccount NOTIFY currentSubaddressAccountChanged)
     Q_PROPERTY(bool synchronized READ synchronized)
+    Q_PROPERTY(quint64 daemonHeight READ daemonBlockChainHeight NOTIFY daemonStatusChanged)
+    Q_PROPERTY(quint64 daemonTargetHeight READ daemonBlockChainTargetHeight NOTIFY daemonStatusChanged)
+    Q_PROPERTY(bool daemonSynchronized READ daemonSynchronized NOTIFY daemonStatusChanged)
     Q_PROPERTY(QString errorString READ errorString)
     Q_PROPERTY(TransactionHistory * history READ history)
     Q_PROPERTY(TransactionHistorySortFilterModel * historyModel READ historyModel NOTIFY historyModelChanged)
@@ -82,6 +94,11 @@ class Wallet : public QObject, public PassprasePrompter
     Q_PROPERTY(SubaddressModel * subaddressModel READ subaddressModel)
     Q_PROPERTY(Subaddress * subaddress READ subaddress)
     Q_PROPERTY(SubaddressAccountModel * subaddressAccountModel READ subaddressAccountModel)
+    Q_PROPERTY(AccountBalanceModel * balanceModel READ balanceModel CONSTANT)
+    Q_PROPERTY(quint64 accountBalance READ balance NOTIFY balanceChanged)
+    Q_PROPERTY(quint64 accountUnlockedBalance READ unlockedBalance NOTIFY balanceChanged)
+    Q_PROPERTY(quint64 totalBalance READ balanceAll NOTIFY balanceChanged)
+    Q_PROPERTY(quint64 totalUnlockedBalance READ unlockedBalanceAll NOTIFY balanceChanged)
     Q_PROPERTY(SubaddressAccount * subaddressAccount READ subaddressAccount)
     Q_PROPERTY(bool viewOnly READ viewOnly)
     Q_PROPERTY(QString secretViewKey READ getSecretViewKey)
@@ -90,6 +107,20 @@ class Wallet : public QObject, public PassprasePrompter
     Q_PROPERTY(QString publicSpendKey READ getPublicSpendKey)
     Q_PROPERTY(QString daemonLogPath READ getDaemonLogPath CONSTANT)
     Q_PROPERTY(QString proxyAddress READ getProxyAddress WRITE setProxyAddress NOTIFY proxyAddressChanged)
+    Q_PROPERTY(QString refreshPolicy READ refreshPolicy WRITE setRefreshPolicy NOTIFY refreshPolicyChanged)
+    Q_PROPERTY(QString chainNotificationAddress READ chainNotificationAddress WRITE setChainNotificationAddress NOTIFY chainNotificationAddressChanged)
+    Q_PROPERTY(int refreshDelay READ refreshDelay NOTIFY refreshScheduleChanged)
+    Q_PROPERTY(QString refreshReason READ refreshReason NOTIFY refreshScheduleChanged)
+    Q_PROPERTY(quint64 syncBlocksScanned READ syncBlocksScanned NOTIFY syncMetricsChanged)
+    Q_PROPERTY(double syncBlocksPerSecond READ syncBlocksPerSecond NOTIFY syncMetricsChanged)
+    Q_PROPERTY(double syncRefreshMs READ syncRefreshMs NOTIFY syncMetricsChanged)
+    Q_PROPERTY(double syncLockWaitMs READ syncLockWaitMs NOTIFY syncMetricsChanged)
+    Q_PROPERTY(double syncWalletMs READ syncWalletMs NOTIFY syncMetricsChanged)
+    Q_PROPERTY(double syncHistoryMs READ syncHistoryMs NOTIFY syncMetricsChanged)
+    Q_PROPERTY(double syncSubaddressMs READ syncSubaddressMs NOTIFY syncMetricsChanged)
+    Q_PROPERTY(double syncSubaddressAccountMs READ syncSubaddressAccountMs NOTIFY syncMetricsChanged)
+    Q_PROPERTY(qint64 syncEtaSeconds READ syncEtaSeconds NOTIFY syncMetricsChanged)
+    Q_PROPERTY(int syncMetricsLogInterval READ syncMetricsLogInterval WRITE setSyncMetricsLogInterval NOTIFY syncMetricsLogIntervalChanged)
     Q_PROPERTY(quint64 walletCreationHeight READ getWalletCreationHeight WRITE setWalletCreationHeight NOTIFY walletCreationHeightChanged)
 
 public:
@@ -127,9 +158,25 @@ public:
     //! returns network type of the wallet.
     NetworkType::Type nettype() const;
 
+    //! everything known about the daemon as of one poll, never modified once published
+    struct DaemonStatus
+    {
+        ConnectionStatus connection = ConnectionStatus_Disconnected;
+        quint64 height = 0;
+        //! never below height, so that a snapshot can't claim the daemon went backwards
+        quint64 targetHeight = 0;
+        //! the daemon has caught up with the network
+        bool synchronized = false;
+        std::chrono::steady_clock::time_point polledAt;
+    };
+
+    //! latest daemon status, all fields come from the same poll
+    std::shared_ptr<const DaemonStatus> daemonStatus() const;
+
     //! returns whether the wallet is connected, and version status
     Q_INVOKABLE ConnectionStatus connected(bool forceCheck = false);
-    void updateConnectionStatusAsync();
+    //! polls the daemon on a worker unless the snapshot is still fresh, requests made meanwhile are coalesced
+    void updateDaemonStatusAsync(bool force = false);
 
     //! returns true if wallet was ever synchronized
     bool synchronized() const;
@@ -173,6 +220,18 @@ public:
     //! indicates id daemon is trusted
     Q_INVOKABLE void setTrustedDaemon(bool arg);
 
+    //! balances of every subaddress account, never modified once published
+    struct Balances
+    {
+        QVector<quint64> balance;
+        QVector<quint64> unlockedBalance;
+        quint64 balanceAll = 0;
+        quint64 unlockedBalanceAll = 0;
+    };
+
+    //! cached balances, recomputed on a worker whenever the wallet reports a change
+    std::shared_ptr<const Balances> balances() const;
+
     //! returns balance
     Q_INVOKABLE quint64 balance() const;
     Q_INVOKABLE quint64 balance(quint32 accountIndex) const;
@@ -215,13 +274,40 @@ public:
     //! scan transactions
     Q_INVOKABLE bool scanTransactions(const QVector<QString> &txids);
 
-    //! refreshes the wallet
+    //! refreshes the wallet, history and subaddresses are rebuilt on workers afterwards
     Q_INVOKABLE bool refresh(bool historyAndSubaddresses = true);
 
     // pause/resume refresh
     Q_INVOKABLE void startRefresh();
     Q_INVOKABLE void pauseRefresh();
 
+    //! name of the active refresh policy, "adaptive" or "fixed"
+    QString refreshPolicy() const;
+    void setRefreshPolicy(const QString &name);
+    //! last scheduling decision of the refresh policy, delay in milliseconds
+    int refreshDelay() const;
+    QString refreshReason() const;
+    //! feeds window visibility and user idle time to the refresh policy
+    Q_INVOKABLE void setUserActivity(bool windowVisible, int idleSeconds);
+    //! zmq endpoint of a local daemon's chain events, empty to rely on polling only
+    QString chainNotificationAddress() const;
+    void setChainNotificationAddress(const QString &address);
+
+    //! refresh metrics over the last refreshes, durations are averages in milliseconds
+    quint64 syncBlocksScanned() const;
+    double syncBlocksPerSecond() const;
+    double syncRefreshMs() const;
+    double syncLockWaitMs() const;
+    double syncWalletMs() const;
+    double syncHistoryMs() const;
+    double syncSubaddressMs() const;
+    double syncSubaddressAccountMs() const;
+    //! seconds until the daemon target height is reached, -1 when unknown
+    qint64 syncEtaSeconds() const;
+    //! logs the refresh metrics at most every given number of seconds, 0 disables logging
+    int syncMetricsLogInterval() const;
+    void setSyncMetricsLogInterval(int seconds);
+
     //! creates async transaction
     Q_INVOKABLE void createTransactionAsync(
         const QVector<QString> &destinationAddresses,
@@ -244,6 +330,9 @@ public:
     //! creates async sweep unmixable transaction
     Q_INVOKABLE void createSweepUnmixableTransactionAsync();
 
+    //! cancels the pending transaction creation, transactionCreated is not emitted for it
+    Q_INVOKABLE void cancelCreateTransaction();
+
     //! Sign a transfer from file
     Q_INVOKABLE UnsignedTransaction * loadTxFile(const QString &fileName);
 
@@ -289,6 +378,9 @@ public:
     //! returns subadress account model
     SubaddressAccountModel *subaddressAccountModel() const;
 
+    //! returns the cached per account balance model
+    AccountBalanceModel *balanceModel() const;
+
     //! generate payment id
     Q_INVOKABLE QString generatePaymentId() const;
 
@@ -365,6 +457,8 @@ signals:
     // signalling only after we
     void refreshed();
 
+    //! the cached balances or the current account changed
+    void balanceChanged() const;
     void moneySpent(const QString &txId, quint64 amount);
     void moneyReceived(const QString &txId, quint64 amount);
     void unconfirmedMoneyReceived(const QString &txId, quint64 amount);
@@ -377,6 +471,7 @@ signals:
     void walletPassphraseNeeded(bool onDevice);
     void transactionCommitted(bool status, PendingTransaction *t, const QStringList& txid);
     void heightRefreshed(quint64 walletHeight, quint64 daemonHeight, quint64 targetHeight) const;
+    void daemonStatusChanged() const;
     void deviceShowAddressShowed();
 
     // emitted when transaction is created async
@@ -390,7 +485,14 @@ signals:
     void currentSubaddressAccountChanged() const;
     void disconnectedChanged() const;
     void proxyAddressChanged() const;
+    void refreshPolicyChanged() const;
+    void chainNotificationAddressChanged() const;
+    void refreshScheduleChanged() const;
+    void syncMetricsChanged() const;
+    void syncMetricsLogIntervalChanged() const;
     void refreshingChanged() const;
+    //! emitted by the subaddress worker, the rows are swapped in on the wallet's thread
+    void subaddressesBuilt() const;
 
 private:
     Wallet(QObject * parent = nullptr);
@@ -401,12 +503,17 @@ private:
     //! (can be less than daemon's blockchain height when wallet sync in progress)
     quint64 blockChainHeight() const;
 
-    //! returns daemon's blockchain height
+    //! returns daemon's blockchain height, as of the latest daemon status
     quint64 daemonBlockChainHeight() const;
 
-    //! returns daemon's blockchain target height
+    //! returns daemon's blockchain target height, as of the latest daemon status
     quint64 daemonBlockChainTargetHeight() const;
 
+    bool daemonSynchronized() const;
+
+    //! queries the daemon and publishes a new status unless another caller just did, any thread
+    std::shared_ptr<const DaemonStatus> pollDaemonStatus(bool force);
+
     //! initializes wallet
     bool init(
         const QString &daemonAddress,
@@ -431,6 +538,21 @@ private:
     QString getProxyAddress() const;
     void setProxyAddress(QString address);
     void startRefreshThread();
+    void recordSyncMetrics(const SyncMetrics::Sample &sample, quint64 walletHeight);
+    //! runs a rebuild that follows a refresh on a worker, between scans, and records its duration
+    //! with the refresh
+    void runRebuild(SyncMetrics::Phase phase, const std::function<void ()> &rebuild);
+    void refreshBalancesAsync();
+    //! rebuilds the subaddresses and accounts on a worker, call on the wallet's thread
+    void refreshSubaddressesAsync();
+    void onSubaddressesBuilt();
+    bool store(const QString &path);
+    void stopRefreshThread();
+    std::chrono::seconds daemonStatusTtl() const;
+    void onChainBlock(quint64 height);
+    void onTxPoolAdded();
+    //! wakes the refresh thread for an immediate refresh, if refreshing is enabled
+    void wakeRefreshThread() const;
 
 private:
     friend class WalletManager;
@@ -444,15 +566,11 @@ private:
     mutable TransactionHistorySortFilterModel * m_historySortFilterModel;
     AddressBook * m_addressBook;
     mutable AddressBookModel * m_addressBookModel;
-    mutable QElapsedTimer m_daemonBlockChainHeightTime;
-    mutable quint64 m_daemonBlockChainHeight;
-    int     m_daemonBlockChainHeightTtl;
-    mutable QElapsedTimer m_daemonBlockChainTargetHeightTime;
-    mutable quint64 m_daemonBlockChainTargetHeight;
-    int     m_daemonBlockChainTargetHeightTtl;
+    // swapped atomically by pollDaemonStatus()
+    std::shared_ptr<const DaemonStatus> m_daemonStatus;
+    // serializes daemon polls, a caller that waited on it reuses the status just published
+    QMutex m_daemonStatusMutex;
     mutable ConnectionStatus m_connectionStatus;
-    int     m_connectionStatusTtl;
-    mutable QElapsedTimer m_connectionStatusTime;
     bool m_disconnected;
     std::atomic<bool> m_initialized;
     std::atomic<bool> m_initializing;
@@ -461,18 +579,51 @@ private:
     mutable SubaddressModel * m_subaddressModel;
     SubaddressAccount * m_subaddressAccount;
     mutable SubaddressAccountModel * m_subaddressAccountModel;
-    QMutex m_asyncMutex;
-    QMutex m_connectionStatusMutex;
-    bool m_connectionStatusRunning;
+    // swaps in the latest subaddress rebuild, set by the worker
+    QMutex m_subaddressesBuiltMutex;
+    std::function<void ()> m_publishSubaddresses;
+    // swapped atomically by the balance worker
+    std::shared_ptr<const Balances> m_balances;
+    mutable AccountBalanceModel * m_balanceModel;
+    // held while wallet2 scans blocks or rescans spent outputs and by the history and subaddress
+    // rebuilds that read its transfers on workers, other read-only queries never take it
+    QMutex m_scanMutex;
+    // serializes stores, a store interrupts a running scan instead of waiting for it to finish
+    QMutex m_storeMutex;
+    std::atomic<bool> m_scanning;
+    std::atomic<bool> m_storePending;
+    // rebuilds waiting for the scan lock, a scan about to start yields to them
+    std::atomic<int> m_rebuildsWaiting;
+    std::atomic<bool> m_scanYielded;
     QString m_daemonUsername;
     QString m_daemonPassword;
     QString m_proxyAddress;
     mutable QMutex m_proxyMutex;
-    std::atomic<bool> m_refreshNow;
-    std::atomic<bool> m_refreshEnabled;
+    // refresh thread state, guarded by m_refreshMutex and signalled through m_refreshCondition
+    mutable QMutex m_refreshMutex;
+    mutable QWaitCondition m_refreshCondition;
+    std::unique_ptr<RefreshPolicy> m_refreshPolicy;
+    RefreshDecision m_refreshDecision;
+    bool m_refreshNow;
+    mutable bool m_refreshReschedule;
+    mutable bool m_daemonHeightChanged;
+    bool m_poolChanged;
+    bool m_windowVisible;
+    int m_idleSeconds;
+    bool m_refreshEnabled;
+    bool m_refreshStopping;
+    std::thread m_refreshThread;
+    ChainNotifier *m_chainNotifier;
+    SyncMetrics m_syncMetrics;
+    std::atomic<int> m_syncMetricsLogInterval;
+    QMutex m_syncMetricsLogMutex;
+    QElapsedTimer m_syncMetricsLogTime;
     std::atomic<bool> m_refreshing;
     WalletListenerImpl *m_walletListener;
     FutureScheduler m_scheduler;
+    // the latest transaction creation and fee estimate, starting a new one cancels the previous
+    CancellationToken m_createTransactionToken;
+    CancellationToken m_feeEstimateToken;
 };
 
 
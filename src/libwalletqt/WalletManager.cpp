@@ -138,7 +138,7 @@ void WalletManager::openWalletAsync(const QString &path, const QString &password
 {
     m_scheduler.run([this, path, password, nettype, kdfRounds] {
         emit walletOpened(openWallet(path, password, nettype, kdfRounds));
-    });
+    }, FutureScheduler::Lane::Dedicated, FutureScheduler::Priority_Normal, "openWallet");
 }
 
 
@@ -209,7 +209,7 @@ void WalletManager::createWalletFromDeviceAsync(const QString &path, const QStri
     m_scheduler.run([this, path, password, nettype, deviceName, restoreHeight, subaddressLookahead, kdfRounds] {
         Wallet *wallet = createWalletFromDevice(path, password, nettype, deviceName, restoreHeight, subaddressLookahead, kdfRounds);
         emit walletCreated(wallet);
-    });
+    }, FutureScheduler::Lane::Dedicated);
 }
 
 QString WalletManager::closeWallet()
@@ -230,7 +230,7 @@ void WalletManager::closeWalletAsync(const QJSValue& callback)
 {
     m_scheduler.run([this] {
         return QJSValueList({closeWallet()});
-    }, callback);
+    }, callback, FutureScheduler::Lane::Dedicated);
 }
 
 bool WalletManager::walletExists(const QString &path) const
@@ -316,7 +316,7 @@ QString WalletManager::paymentIdFromAddress(const QString &address, NetworkType:
 
 void WalletManager::setDaemonAddressAsync(const QString &address)
 {
-    m_scheduler.run([this, address] {
+    m_scheduler.runKeyed("daemonAddress", [this, address] {
         m_pimpl->setDaemonAddress(address.toStdString());
     });
 }
@@ -361,9 +361,9 @@ bool WalletManager::isMining() const
 
 void WalletManager::miningStatusAsync()
 {
-    m_scheduler.run([this] {
+    m_scheduler.runKeyed("miningStatus", [this] {
         emit miningStatus(isMining());
-    });
+    }, FutureScheduler::Lane::Background, FutureScheduler::Priority_Low);
 }
 
 bool WalletManager::startMining(const QString &address, quint32 threads, bool backgroundMining, bool ignoreBattery)
@@ -523,7 +523,7 @@ void WalletManager::checkUpdatesAsync(
         {
             const QString binaryFilename = QUrl(downloadUrl).fileName();
             QPair<QString, QString> signers;
-            const QString signedHash = Updater().fetchSignedHash(binaryFilename, hashFromDns, signers).toHex();
+            const QString signedHash = Updater().fetchSignedHash(binaryFilename, hashFromDns, signers, proxyAddress()).toHex();
 
             qInfo() << "Update found" << version << downloadUrl << "hash" << signedHash << "signed by" << signers;
             emit checkUpdatesComplete(version, downloadUrl, signedHash, signers.first, signers.second);
@@ -532,7 +532,7 @@ void WalletManager::checkUpdatesAsync(
         {
             qCritical() << "Failed to fetch and verify signed hash:" << e.what();
         }
-    });
+    }, FutureScheduler::Lane::Background, FutureScheduler::Priority_Low);
 }
 
 QString WalletManager::checkUpdates(const QString &software, const QString &subdir) const
@@ -597,7 +597,7 @@ QString WalletManager::proxyAddress() const
 
 void WalletManager::setProxyAddress(QString address)
 {
-    m_scheduler.run([this, address] {
+    m_scheduler.runKeyed("proxyAddress", [this, address] {
         {
             QMutexLocker locker(&m_proxyMutex);
 
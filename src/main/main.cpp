@@ -60,11 +60,16 @@
 #include "model/SubaddressModel.h"
 #include "SubaddressAccount.h"
 #include "model/SubaddressAccountModel.h"
+#include "model/AccountBalanceModel.h"
 #include "Logger.h"
 #include "MainApp.h"
 #include "qt/downloader.h"
+#include "qt/FutureScheduler.h"
+#include "qt/SchedulerMonitor.h"
 #include "qt/ipc.h"
 #include "qt/network.h"
+#include "qt/PriceFeed.h"
+#include "qt/RemoteNodeHealth.h"
 #include "qt/updater.h"
 #include "qt/utils.h"
 #include "qt/TailsOS.h"
@@ -305,6 +310,22 @@ Verify update binary using 'shasum'-compatible (SHA256 algo) output signed by tw
         Monero::WalletManagerFactory::setLogLevel(logLevel);
     }
 
+    // async task lanes are sized by default, MONERO_*_THREADS env vars override them
+    const QList<QPair<const char *, FutureScheduler::Lane>> laneThreadVariables = {
+        {"MONERO_INTERACTIVE_THREADS", FutureScheduler::Lane::Interactive},
+        {"MONERO_BACKGROUND_THREADS", FutureScheduler::Lane::Background},
+        {"MONERO_DEDICATED_THREADS", FutureScheduler::Lane::Dedicated},
+    };
+    for (const auto &variable : laneThreadVariables)
+    {
+        bool threadsOk;
+        const int threads = qEnvironmentVariableIntValue(variable.first, &threadsOk);
+        if (threadsOk && threads > 0)
+        {
+            FutureScheduler::setLaneThreadCount(variable.second, threads);
+        }
+    }
+
     if (parser.isSet(verifyUpdateOption))
     {
         const QString updateBinaryFullPath = parser.value(verifyUpdateOption);
@@ -380,6 +401,8 @@ Verify update binary using 'shasum'-compatible (SHA256 algo) output signed by tw
     qmlRegisterType<clipboardAdapter>("moneroComponents.Clipboard", 1, 0, "Clipboard");
     qmlRegisterType<Downloader>("moneroComponents.Downloader", 1, 0, "Downloader");
     qmlRegisterType<Network>("moneroComponents.Network", 1, 0, "Network");
+    qmlRegisterType<RemoteNodeHealth>("moneroComponents.RemoteNodeHealth", 1, 0, "RemoteNodeHealth");
+    qmlRegisterType<PriceFeed>("moneroComponents.PriceFeed", 1, 0, "PriceFeed");
     qmlRegisterType<WalletKeysFilesModel>("moneroComponents.WalletKeysFilesModel", 1, 0, "WalletKeysFilesModel");
     qmlRegisterType<WalletManager>("moneroComponents.WalletManager", 1, 0, "WalletManager");
 
@@ -430,6 +453,9 @@ Verify update binary using 'shasum'-compatible (SHA256 algo) output signed by tw
     qmlRegisterUncreatableType<SubaddressAccountModel>("moneroComponents.SubaddressAccountModel", 1, 0, "SubaddressAccountModel",
                                                         "SubaddressAccountModel can't be instantiated directly");
 
+    qmlRegisterUncreatableType<AccountBalanceModel>("moneroComponents.AccountBalanceModel", 1, 0, "AccountBalanceModel",
+                                                        "AccountBalanceModel can't be instantiated directly");
+
     qmlRegisterUncreatableType<SubaddressAccount>("moneroComponents.SubaddressAccount", 1, 0, "SubaddressAccount",
                                                         "SubaddressAccount can't be instantiated directly");
 
@@ -509,6 +535,9 @@ Verify update binary using 'shasum'-compatible (SHA256 algo) output signed by tw
     engine.rootContext()->setContextProperty("homePath", QDir::homePath());
     engine.rootContext()->setContextProperty("applicationDirectory", QApplication::applicationDirPath());
     engine.rootContext()->setContextProperty("idealThreadCount", QThread::idealThreadCount());
+#ifdef QT_DEBUG
+    engine.rootContext()->setContextProperty("schedulerMonitor", new SchedulerMonitor(&app));
+#endif
 #ifdef WITH_UPDATER
     engine.rootContext()->setContextProperty("disableCheckUpdatesFlag", parser.isSet(disableCheckUpdatesOption));
 #else
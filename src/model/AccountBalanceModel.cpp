@@ -0,0 +1,92 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "AccountBalanceModel.h"
+#include <QDebug>
+#include <QHash>
+
+AccountBalanceModel::AccountBalanceModel(Wallet *wallet)
+    : QAbstractListModel(wallet), m_wallet(wallet), m_balances(wallet->balances())
+{
+    connect(m_wallet, &Wallet::balanceChanged, this, &AccountBalanceModel::update);
+}
+
+void AccountBalanceModel::update()
+{
+    std::shared_ptr<const Wallet::Balances> balances = m_wallet->balances();
+    if (balances == m_balances)
+        return;
+
+    if (balances->balance.size() != m_balances->balance.size())
+    {
+        beginResetModel();
+        m_balances = std::move(balances);
+        endResetModel();
+        return;
+    }
+
+    m_balances = std::move(balances);
+    if (!m_balances->balance.isEmpty())
+        emit dataChanged(index(0), index(m_balances->balance.size() - 1));
+}
+
+int AccountBalanceModel::rowCount(const QModelIndex &) const
+{
+    return m_balances->balance.size();
+}
+
+QVariant AccountBalanceModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_balances->balance.size())
+        return {};
+
+    switch (role) {
+    case AccountBalanceAccountRole:
+        return index.row();
+    case AccountBalanceBalanceRole:
+        return m_balances->balance.at(index.row());
+    case AccountBalanceUnlockedBalanceRole:
+        return m_balances->unlockedBalance.at(index.row());
+    default:
+        qCritical() << "Unimplemented role" << role;
+    }
+
+    return {};
+}
+
+QHash<int, QByteArray> AccountBalanceModel::roleNames() const
+{
+    static QHash<int, QByteArray> roleNames;
+    if (roleNames.empty())
+    {
+        roleNames.insert(AccountBalanceAccountRole, "account");
+        roleNames.insert(AccountBalanceBalanceRole, "balance");
+        roleNames.insert(AccountBalanceUnlockedBalanceRole, "unlockedBalance");
+    }
+    return roleNames;
+}
@@ -33,54 +33,86 @@
 #include <wallet/api/wallet2_api.h>
 
 SubaddressAccountModel::SubaddressAccountModel(QObject *parent, SubaddressAccount *subaddressAccount)
-    : QAbstractListModel(parent), m_subaddressAccount(subaddressAccount)
+    : QAbstractListModel(parent), m_subaddressAccount(subaddressAccount), m_summaries(subaddressAccount->summaries())
 {
-    connect(m_subaddressAccount,SIGNAL(refreshStarted()),this,SLOT(startReset()));
-    connect(m_subaddressAccount,SIGNAL(refreshFinished()),this,SLOT(endReset()));
+    // summaries published by the refresh worker are queued, the model only follows on its own thread
+    connect(m_subaddressAccount, &SubaddressAccount::summariesChanged, this, &SubaddressAccountModel::update);
 }
 
-void SubaddressAccountModel::startReset(){
-    beginResetModel();
-}
-void SubaddressAccountModel::endReset(){
-    endResetModel();
+void SubaddressAccountModel::update()
+{
+    std::shared_ptr<const SubaddressAccount::Summaries> summaries = m_subaddressAccount->summaries();
+    if (summaries == m_summaries)
+        return;
+
+    const int oldCount = static_cast<int>(m_summaries->size());
+    const int newCount = static_cast<int>(summaries->size());
+
+    // accounts are only ever appended, anything else is a different wallet state altogether
+    if (newCount < oldCount)
+    {
+        beginResetModel();
+        m_summaries = std::move(summaries);
+        endResetModel();
+        return;
+    }
+
+    int firstChanged = -1;
+    int lastChanged = -1;
+    for (int row = 0; row < oldCount; ++row)
+    {
+        if ((*m_summaries)[row] != (*summaries)[row])
+        {
+            if (firstChanged < 0)
+                firstChanged = row;
+            lastChanged = row;
+        }
+    }
+
+    if (newCount > oldCount)
+    {
+        beginInsertRows(QModelIndex(), oldCount, newCount - 1);
+        m_summaries = std::move(summaries);
+        endInsertRows();
+    }
+    else
+    {
+        m_summaries = std::move(summaries);
+    }
+
+    if (firstChanged >= 0)
+        emit dataChanged(index(firstChanged), index(lastChanged));
 }
 
 int SubaddressAccountModel::rowCount(const QModelIndex &) const
 {
-    return m_subaddressAccount->count();
+    return static_cast<int>(m_summaries->size());
 }
 
 QVariant SubaddressAccountModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() < 0 || static_cast<quint64>(index.row()) >= m_subaddressAccount->count())
+    if (!index.isValid() || index.row() < 0 || static_cast<size_t>(index.row()) >= m_summaries->size())
         return {};
 
-    QVariant result;
-
-    bool found = m_subaddressAccount->getRow(index.row(), [&result, &role](const Monero::SubaddressAccountRow &row) {
-        switch (role) {
-        case SubaddressAccountAddressRole:
-            result = QString::fromStdString(row.getAddress());
-            break;
-        case SubaddressAccountLabelRole:
-            result = QString::fromStdString(row.getLabel());
-            break;
-        case SubaddressAccountBalanceRole:
-            result = QString::fromStdString(row.getBalance());
-            break;
-        case SubaddressAccountUnlockedBalanceRole:
-            result = QString::fromStdString(row.getUnlockedBalance());
-            break;
-        default:
-            qCritical() << "Unimplemented role" << role;
-        }
-    });
-    if (!found) {
-        qCritical("%s: internal error: invalid index %d", __FUNCTION__, index.row());
+    const SubaddressAccount::Summary &summary = (*m_summaries)[index.row()];
+    switch (role) {
+    case SubaddressAccountAddressRole:
+        return summary.address;
+    case SubaddressAccountLabelRole:
+        return summary.label;
+    case SubaddressAccountBalanceRole:
+        return QString::fromStdString(Monero::Wallet::displayAmount(summary.balance));
+    case SubaddressAccountUnlockedBalanceRole:
+        return QString::fromStdString(Monero::Wallet::displayAmount(summary.unlockedBalance));
+    case SubaddressAccountSubaddressCountRole:
+        return summary.subaddressCount;
+    case SubaddressAccountLastActivityHeightRole:
+        return summary.lastActivityHeight;
+    default:
+        qCritical() << "Unimplemented role" << role;
     }
 
-    return result;
+    return {};
 }
 
 QHash<int, QByteArray> SubaddressAccountModel::roleNames() const
@@ -92,6 +124,8 @@ QHash<int, QByteArray> SubaddressAccountModel::roleNames() const
         roleNames.insert(SubaddressAccountLabelRole, "label");
         roleNames.insert(SubaddressAccountBalanceRole, "balance");
         roleNames.insert(SubaddressAccountUnlockedBalanceRole, "unlockedBalance");
+        roleNames.insert(SubaddressAccountSubaddressCountRole, "subaddressCount");
+        roleNames.insert(SubaddressAccountLastActivityHeightRole, "lastActivityHeight");
     }
     return roleNames;
 }
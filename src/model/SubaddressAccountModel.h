@@ -29,9 +29,11 @@
 #ifndef SUBADDRESSACCOUNTMODEL_H
 #define SUBADDRESSACCOUNTMODEL_H
 
+#include <memory>
+
 #include <QAbstractListModel>
 
-class SubaddressAccount;
+#include "SubaddressAccount.h"
 
 class SubaddressAccountModel : public QAbstractListModel
 {
@@ -44,6 +46,8 @@ public:
         SubaddressAccountLabelRole,
         SubaddressAccountBalanceRole,
         SubaddressAccountUnlockedBalanceRole,
+        SubaddressAccountSubaddressCountRole,
+        SubaddressAccountLastActivityHeightRole,
     };
     Q_ENUM(SubaddressAccountRowRole)
 
@@ -54,11 +58,13 @@ public:
     QHash<int, QByteArray> roleNames() const  override;
 
 public slots:
-    void startReset();
-    void endReset();
+    //! applies the latest summaries as row insertions, removals and changes
+    void update();
 
 private:
     SubaddressAccount *m_subaddressAccount;
+    // the summaries the views were last told about, the model's rows
+    std::shared_ptr<const SubaddressAccount::Summaries> m_summaries;
 };
 
 #endif // SUBADDRESSACCOUNTMODEL_H
@@ -29,13 +29,50 @@
 #include "TransactionHistoryModel.h"
 #include "TransactionHistory.h"
 #include "TransactionInfo.h"
+#include "TransactionStore.h"
+#include "WalletManager.h"
 
 #include <QDateTime>
 #include <QDebug>
 
 
+namespace {
+    /**
+     * slot of a role in the per-row display cache, -1 for roles which are cheap to compute
+     */
+    int cacheSlot(int role)
+    {
+        switch (role)
+        {
+        case TransactionHistoryModel::TransactionAmountRole:
+            return 0;
+        case TransactionHistoryModel::TransactionDisplayAmountRole:
+            return 1;
+        case TransactionHistoryModel::TransactionFeeRole:
+            return 2;
+        case TransactionHistoryModel::TransactionSubaddrIndexRole:
+            return 3;
+        case TransactionHistoryModel::TransactionLabelRole:
+            return 4;
+        case TransactionHistoryModel::TransactionHashRole:
+            return 5;
+        case TransactionHistoryModel::TransactionTimeStampRole:
+            return 6;
+        case TransactionHistoryModel::TransactionDateRole:
+            return 7;
+        case TransactionHistoryModel::TransactionTimeRole:
+            return 8;
+        case TransactionHistoryModel::TransactionDestinationsRole:
+            return 9;
+        default:
+            return -1;
+        }
+    }
+}
+
+
 TransactionHistoryModel::TransactionHistoryModel(QObject *parent)
-    : QAbstractListModel(parent), m_transactionHistory(nullptr)
+    : QAbstractListModel(parent), m_transactionHistory(nullptr), m_pendingFirst(0), m_pendingLast(-1)
 {
 
 }
@@ -44,84 +81,151 @@ void TransactionHistoryModel::setTransactionHistory(TransactionHistory *th)
 {
     beginResetModel();
     m_transactionHistory = th;
+    m_displayCache.clear();
+    m_displayCache.resize(rowCount());
     endResetModel();
 
     connect(m_transactionHistory, &TransactionHistory::refreshStarted,
             this, &TransactionHistoryModel::beginResetModel);
     connect(m_transactionHistory, &TransactionHistory::refreshFinished,
-            this, &TransactionHistoryModel::endResetModel);
+            this, &TransactionHistoryModel::onRefreshFinished);
+    connect(m_transactionHistory, &TransactionHistory::transactionsAboutToBeRemoved,
+            this, &TransactionHistoryModel::onTransactionsAboutToBeRemoved);
+    connect(m_transactionHistory, &TransactionHistory::transactionsRemoved,
+            this, &TransactionHistoryModel::onTransactionsRemoved);
+    connect(m_transactionHistory, &TransactionHistory::transactionsAboutToBeInserted,
+            this, &TransactionHistoryModel::onTransactionsAboutToBeInserted);
+    connect(m_transactionHistory, &TransactionHistory::transactionsInserted,
+            this, &TransactionHistoryModel::onTransactionsInserted);
+    connect(m_transactionHistory, &TransactionHistory::transactionsChanged,
+            this, &TransactionHistoryModel::onTransactionsChanged);
 
     emit transactionHistoryChanged();
 }
 
+void TransactionHistoryModel::onRefreshFinished()
+{
+    m_displayCache.clear();
+    m_displayCache.resize(rowCount());
+    endResetModel();
+}
+
+void TransactionHistoryModel::onTransactionsAboutToBeRemoved(int first, int last)
+{
+    m_pendingFirst = first;
+    m_pendingLast = last;
+    beginRemoveRows(QModelIndex(), first, last);
+}
+
+void TransactionHistoryModel::onTransactionsRemoved()
+{
+    m_displayCache.remove(m_pendingFirst, m_pendingLast - m_pendingFirst + 1);
+    endRemoveRows();
+}
+
+void TransactionHistoryModel::onTransactionsAboutToBeInserted(int first, int last)
+{
+    m_pendingFirst = first;
+    m_pendingLast = last;
+    beginInsertRows(QModelIndex(), first, last);
+}
+
+void TransactionHistoryModel::onTransactionsInserted()
+{
+    m_displayCache.insert(m_pendingFirst, m_pendingLast - m_pendingFirst + 1, DisplayCacheRow());
+    endInsertRows();
+}
+
+void TransactionHistoryModel::onTransactionsChanged(int first, int last, bool confirmationsOnly)
+{
+    QVector<int> roles;
+    if (confirmationsOnly) {
+        roles.append(TransactionConfirmationsRole);
+    } else {
+        // confirmations are never cached, anything else may be stale
+        for (int row = first; row <= last && row < m_displayCache.size(); ++row) {
+            m_displayCache[row] = DisplayCacheRow();
+        }
+    }
+    emit dataChanged(index(first), index(last), roles);
+}
+
 TransactionHistory *TransactionHistoryModel::transactionHistory() const
 {
     return m_transactionHistory;
 }
 
-QVariant TransactionHistoryModel::parseTransactionInfo(const TransactionInfo &tInfo, int role) const
+QVariant TransactionHistoryModel::parseTransactionInfo(const TransactionStore &store, int row, int role) const
 {
     switch (role)
     {
     case TransactionDirectionRole:
-        return QVariant::fromValue(tInfo.direction());
+        return QVariant::fromValue(store.direction(row));
     case TransactionPendingRole:
-        return tInfo.isPending();
+        return store.isPending(row);
     case TransactionFailedRole:
-        return tInfo.isFailed();
+        return store.isFailed(row);
     case TransactionAmountRole:
-        return tInfo.amount();
+        // there's no unsigned uint64 for JS, so better use double
+        return WalletManager::displayAmount(store.amount(row)).toDouble();
     case TransactionDisplayAmountRole:
-        return tInfo.displayAmount();
+        return WalletManager::displayAmount(store.amount(row));
     case TransactionAtomicAmountRole:
-        return tInfo.atomicAmount();
+        return store.amount(row);
     case TransactionFeeRole:
-        return tInfo.fee();
+        return store.fee(row) == 0 ? QString("") : WalletManager::displayAmount(store.fee(row));
     case TransactionBlockHeightRole:
     {
         // Use NULL QVariant for transactions without height.
         // Forces them to be displayed at top when sorted by blockHeight.
-        if (tInfo.blockHeight() != 0)
+        if (store.blockHeight(row) != 0)
         {
-            return tInfo.blockHeight();
+            return store.blockHeight(row);
         }
         return QVariant();
     }
     case TransactionSubaddrIndexRole:
     {
         QString str = QString{""};
-        bool first = true;
-        for (quint32 i : tInfo.subaddrIndex())
+        for (int i = 0; i < store.subaddrIndexCount(row); ++i)
         {
-            if (!first)
+            if (i > 0)
                 str += QString{","};
-            first = false;
-            str += QString::number(i);
+            str += QString::number(store.subaddrIndex(row, i));
         }
         return str;
     }
     case TransactionSubaddrAccountRole:
-        return tInfo.subaddrAccount();
+        return store.subaddrAccount(row);
     case TransactionLabelRole:
-        return tInfo.subaddrIndex().size() == 1 && *tInfo.subaddrIndex().begin() == 0 ? tr("Primary address") : tInfo.label();
+        return store.subaddrIndexCount(row) == 1 && store.subaddrIndex(row, 0) == 0 ? tr("Primary address") : store.label(row);
     case TransactionConfirmationsRole:
-        return tInfo.confirmations();
+        return store.confirmations(row);
     case TransactionConfirmationsRequiredRole:
-        return (tInfo.blockHeight() < tInfo.unlockTime()) ? tInfo.unlockTime() - tInfo.blockHeight() : 10;
+        return (store.blockHeight(row) < store.unlockTime(row)) ? store.unlockTime(row) - store.blockHeight(row) : 10;
     case TransactionHashRole:
-        return tInfo.hash();
+        return store.hash(row);
     case TransactionTimeStampRole:
-        return tInfo.timestamp();
+        return QDateTime::fromSecsSinceEpoch(store.timestamp(row));
     case TransactionPaymentIdRole:
-        return tInfo.paymentId();
+        return store.paymentId(row);
     case TransactionIsOutRole:
-        return tInfo.direction() == TransactionInfo::Direction_Out;
+        return store.direction(row) == TransactionInfo::Direction_Out;
     case TransactionDateRole:
-        return tInfo.date();
+        return QDateTime::fromSecsSinceEpoch(store.timestamp(row)).date().toString(Qt::ISODate);
     case TransactionTimeRole:
-        return tInfo.time();
+        return QDateTime::fromSecsSinceEpoch(store.timestamp(row)).time().toString(Qt::ISODate);
     case TransactionDestinationsRole:
-        return tInfo.destinations_formatted();
+    {
+        QString destinations;
+        for (int i = 0; i < store.transferCount(row); ++i)
+        {
+            if (!destinations.isEmpty())
+                destinations += "<br> ";
+            destinations += WalletManager::displayAmount(store.transferAmount(row, i)) + ": " + store.transferAddress(row, i);
+        }
+        return destinations;
+    }
     default:
     {
         qCritical() << "Unimplemented role" << role;
@@ -136,12 +240,24 @@ QVariant TransactionHistoryModel::data(const QModelIndex &index, int role) const
         return QVariant();
     }
 
-    QVariant result;
-    bool found = m_transactionHistory->transaction(index.row(), [this, &result, &role](const TransactionInfo &tInfo) {
-        result = parseTransactionInfo(tInfo, role);
-    });
-    if (!found) {
+    const int slot = cacheSlot(role);
+    const bool cacheable = slot >= 0 && index.row() >= 0 && index.row() < m_displayCache.size();
+    if (cacheable) {
+        const QVariant &cached = m_displayCache[index.row()][slot];
+        if (cached.isValid()) {
+            return cached;
+        }
+    }
+
+    const std::shared_ptr<const TransactionStore> store = m_transactionHistory->snapshot();
+    if (index.row() < 0 || index.row() >= store->size()) {
         qCritical("%s: internal error: no transaction info for index %d", __FUNCTION__, index.row());
+        return QVariant();
+    }
+
+    const QVariant result = parseTransactionInfo(*store, index.row(), role);
+    if (cacheable) {
+        m_displayCache[index.row()][slot] = result;
     }
     return result;
 }
@@ -29,10 +29,13 @@
 #ifndef TRANSACTIONHISTORYMODEL_H
 #define TRANSACTIONHISTORYMODEL_H
 
+#include <array>
+
 #include <QAbstractListModel>
+#include <QVector>
 
 class TransactionHistory;
-class TransactionInfo;
+class TransactionStore;
 
 /**
  * @brief The TransactionHistoryModel class - read-only list model for Transaction History
@@ -96,11 +99,27 @@ public:
 signals:
     void transactionHistoryChanged();
 
+private slots:
+    void onRefreshFinished();
+    void onTransactionsAboutToBeRemoved(int first, int last);
+    void onTransactionsRemoved();
+    void onTransactionsAboutToBeInserted(int first, int last);
+    void onTransactionsInserted();
+    void onTransactionsChanged(int first, int last, bool confirmationsOnly);
+
 private:
-    QVariant parseTransactionInfo(const TransactionInfo &tInfo, int role) const;
+    QVariant parseTransactionInfo(const TransactionStore &store, int row, int role) const;
 
 private:
+    // formatted values of the expensive roles, filled lazily by data() and
+    // dropped only for rows the history reports as changed
+    static constexpr int DisplayCacheSlots = 10;
+    using DisplayCacheRow = std::array<QVariant, DisplayCacheSlots>;
+
     TransactionHistory * m_transactionHistory;
+    mutable QVector<DisplayCacheRow> m_displayCache;
+    int m_pendingFirst;
+    int m_pendingLast;
 };
 
 #endif // TRANSACTIONHISTORYMODEL_H
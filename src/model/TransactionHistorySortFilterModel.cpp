@@ -28,6 +28,14 @@
 
 #include "TransactionHistorySortFilterModel.h"
 #include "TransactionHistoryModel.h"
+#include "TransactionHistory.h"
+#include "TransactionSearchIndex.h"
+#include "TransactionStore.h"
+#include "WalletManager.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
 
 #include <QDebug>
 #include <QtGlobal>
@@ -62,13 +70,103 @@ namespace {
         scopeFilter[scopeIndex] = QVariant::fromValue(value);
         filters[role] = scopeFilter;
     }
+
+    /**
+     * helper returning the local midnight of a date as epoch seconds
+     */
+    qint64 startOfDay(const QDate &date)
+    {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        return date.startOfDay().toSecsSinceEpoch();
+#else
+        return QDateTime(date).toSecsSinceEpoch();
+#endif
+    }
+
+    /**
+     * transfers to the same account carry a zero amount, the destinations have the real one
+     */
+    quint64 effectiveAmount(const TransactionStore &txs, int row)
+    {
+        quint64 amount = txs.amount(row);
+        if (amount != 0) {
+            return amount;
+        }
+        for (int i = 0; i < txs.transferCount(row); ++i) {
+            amount += txs.transferAmount(row, i);
+        }
+        return amount;
+    }
+
+    quint64 sortKey(const TransactionStore &txs, int row, int sortRole)
+    {
+        switch (sortRole) {
+        case TransactionHistoryModel::TransactionTimeStampRole:
+            return txs.timestamp(row);
+        case TransactionHistoryModel::TransactionAmountRole:
+            return effectiveAmount(txs, row);
+        default:
+            // transactions without height go on top of the descending order
+            return txs.blockHeight(row) != 0 ? txs.blockHeight(row) : std::numeric_limits<quint64>::max();
+        }
+    }
 }
 
 
 TransactionHistorySortFilterModel::TransactionHistorySortFilterModel(QObject *parent)
     : QSortFilterProxyModel(parent)
+    , m_searchIndexCurrent(false)
+    , m_searchIndexBuilding(false)
+    , m_sourceGeneration(0)
+    , m_searchGeneration(0)
+    , m_scheduler(this)
 {
     setDynamicSortFilter(true);
+    connect(this, &TransactionHistorySortFilterModel::searchFinished,
+            this, &TransactionHistorySortFilterModel::onSearchFinished, Qt::QueuedConnection);
+    connect(this, &TransactionHistorySortFilterModel::searchIndexBuilt,
+            this, &TransactionHistorySortFilterModel::onSearchIndexBuilt, Qt::QueuedConnection);
+}
+
+TransactionHistorySortFilterModel::~TransactionHistorySortFilterModel()
+{
+    shutdown();
+}
+
+void TransactionHistorySortFilterModel::shutdown()
+{
+    m_scheduler.shutdownWaitForFinished();
+}
+
+void TransactionHistorySortFilterModel::setSearchAnnotator(TransactionSearchIndex::Annotator annotator)
+{
+    m_annotator = std::move(annotator);
+    invalidateSearchIndex();
+}
+
+void TransactionHistorySortFilterModel::invalidateAnnotations()
+{
+    invalidateSearchIndex();
+}
+
+void TransactionHistorySortFilterModel::setSourceModel(QAbstractItemModel *model)
+{
+    if (sourceModel()) {
+        disconnect(sourceModel(), &QAbstractItemModel::modelReset, this, &TransactionHistorySortFilterModel::onSourceReset);
+        disconnect(sourceModel(), &QAbstractItemModel::rowsInserted, this, &TransactionHistorySortFilterModel::onSourceRowsInserted);
+        disconnect(sourceModel(), &QAbstractItemModel::rowsRemoved, this, &TransactionHistorySortFilterModel::onSourceRowsRemoved);
+        disconnect(sourceModel(), &QAbstractItemModel::dataChanged, this, &TransactionHistorySortFilterModel::onSourceDataChanged);
+    }
+
+    QSortFilterProxyModel::setSourceModel(model);
+    invalidateSearchIndex();
+
+    if (model) {
+        connect(model, &QAbstractItemModel::modelReset, this, &TransactionHistorySortFilterModel::onSourceReset);
+        connect(model, &QAbstractItemModel::rowsInserted, this, &TransactionHistorySortFilterModel::onSourceRowsInserted);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, &TransactionHistorySortFilterModel::onSourceRowsRemoved);
+        connect(model, &QAbstractItemModel::dataChanged, this, &TransactionHistorySortFilterModel::onSourceDataChanged);
+    }
 }
 
 QString TransactionHistorySortFilterModel::searchFilter() const
@@ -81,7 +179,14 @@ void TransactionHistorySortFilterModel::setSearchFilter(const QString &arg)
     if (searchFilter() != arg) {
         m_searchString = arg;
         emit searchFilterChanged();
-        invalidateFilter();
+        if (m_searchString.isEmpty()) {
+            // drops any search still in flight
+            ++m_searchGeneration;
+            m_searchMatches.clear();
+            invalidateFilter();
+        } else {
+            scheduleSearch();
+        }
     }
 }
 
@@ -95,6 +200,7 @@ void TransactionHistorySortFilterModel::setPaymentIdFilter(const QString &arg)
     if (paymentIdFilter() != arg) {
         m_filterValues[TransactionHistoryModel::TransactionPaymentIdRole] = arg;
         emit paymentIdFilterChanged();
+        compileFilter();
         invalidateFilter();
     }
 }
@@ -109,6 +215,7 @@ void TransactionHistorySortFilterModel::setDateFromFilter(const QDate &date)
     if (date != dateFromFilter()) {
         setScopeFilterValue(m_filterValues, TransactionHistoryModel::TransactionTimeStampRole, ScopeIndex::From, date);
         emit dateFromFilterChanged();
+        compileFilter();
         invalidateFilter();
     }
 }
@@ -123,6 +230,7 @@ void TransactionHistorySortFilterModel::setDateToFilter(const QDate &date)
     if (date != dateToFilter()) {
         setScopeFilterValue(m_filterValues, TransactionHistoryModel::TransactionTimeStampRole, ScopeIndex::To, date);
         emit dateToFilterChanged();
+        compileFilter();
         invalidateFilter();
     }
 }
@@ -137,6 +245,7 @@ void TransactionHistorySortFilterModel::setAmountFromFilter(double value)
     if (value != amountFromFilter()) {
         setScopeFilterValue(m_filterValues, TransactionHistoryModel::TransactionAmountRole, ScopeIndex::From, value);
         emit amountFromFilterChanged();
+        compileFilter();
         invalidateFilter();
     }
 }
@@ -151,6 +260,7 @@ void TransactionHistorySortFilterModel::setAmountToFilter(double value)
     if (value != amountToFilter()) {
         setScopeFilterValue(m_filterValues, TransactionHistoryModel::TransactionAmountRole, ScopeIndex::To, value);
         emit amountToFilterChanged();
+        compileFilter();
         invalidateFilter();
     }
 }
@@ -165,6 +275,7 @@ void TransactionHistorySortFilterModel::setDirectionFilter(int value)
     if (value != directionFilter()) {
         m_filterValues[TransactionHistoryModel::TransactionDirectionRole] = QVariant::fromValue(value);
         emit directionFilterChanged();
+        compileFilter();
         invalidateFilter();
     }
 }
@@ -175,111 +286,313 @@ void TransactionHistorySortFilterModel::sort(int column, Qt::SortOrder order)
     QSortFilterProxyModel::sort(column, order);
 }
 
-TransactionHistory *TransactionHistorySortFilterModel::transactionHistory() const
+void TransactionHistorySortFilterModel::compileFilter()
 {
-    const TransactionHistoryModel * model = static_cast<const TransactionHistoryModel*> (sourceModel());
-    return model->transactionHistory();
+    FilterPredicate predicate;
+
+    predicate.paymentId = paymentIdFilter();
+
+    predicate.setDates(dateFromFilter(), dateToFilter());
+
+    // non-positive values disable the amount bounds
+    const double amountFrom = amountFromFilter();
+    const double amountTo = amountToFilter();
+    if (amountFrom > 0) {
+        predicate.amountFrom = WalletManager::amountFromString(QString::number(amountFrom, 'f', 12));
+    }
+    if (amountTo > 0) {
+        predicate.amountTo = WalletManager::amountFromString(QString::number(amountTo, 'f', 12));
+    }
+
+    if (m_filterValues.contains(TransactionHistoryModel::TransactionDirectionRole)) {
+        predicate.direction = directionFilter();
+    }
+
+    m_predicate = predicate;
 }
 
-bool TransactionHistorySortFilterModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+void TransactionHistorySortFilterModel::FilterPredicate::setDates(const QDate &dateFrom, const QDate &dateTo)
+{
+    timestampFrom = dateFrom.isValid() ? startOfDay(dateFrom) : std::numeric_limits<qint64>::min();
+    // including upperbound
+    timestampTo = dateTo.isValid() ? startOfDay(dateTo.addDays(1)) : std::numeric_limits<qint64>::max();
+}
+
+bool TransactionHistorySortFilterModel::FilterPredicate::acceptsTimestamp(qint64 timestamp) const
 {
+    return timestamp >= timestampFrom && timestamp < timestampTo;
+}
 
-    if (source_row < 0 || source_row >= sourceModel()->rowCount()) {
+bool TransactionHistorySortFilterModel::FilterPredicate::accepts(const TransactionStore &txs, int row) const
+{
+    if (!acceptsTimestamp(txs.timestamp(row))) {
         return false;
     }
 
-    QModelIndex index = sourceModel()->index(source_row, 0, source_parent);
-    if (!index.isValid()) {
+    // the amount the history shows and sorts by
+    const quint64 amount = effectiveAmount(txs, row);
+    if (amount < amountFrom || amount > amountTo) {
         return false;
     }
 
-    bool result = true;
+    if (direction != TransactionInfo::Direction_Both && txs.direction(row) != direction) {
+        return false;
+    }
 
-    // iterating through filters
-    for (int role : m_filterValues.keys()) {
-        if (m_filterValues.contains(role)) {
-            QVariant data = sourceModel()->data(index, role);
-            switch (role) {
-            case TransactionHistoryModel::TransactionPaymentIdRole:
-                result = data.toString().contains(paymentIdFilter());
-                break;
-            case TransactionHistoryModel::TransactionTimeStampRole:
-            {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-                QDateTime from = dateFromFilter().startOfDay();
-                QDateTime to = dateToFilter().endOfDay();
-#else
-                QDateTime from = QDateTime(dateFromFilter());
-                QDateTime to   = QDateTime(dateToFilter());
-                to = to.addDays(1); // including upperbound
-#endif
-                QDateTime timestamp = data.toDateTime();
-                bool matchFrom = from.isNull() || timestamp.isNull() || timestamp >= from;
-                bool matchTo = to.isNull() || timestamp.isNull() || timestamp <= to;
-                result = matchFrom && matchTo;
-            }
-                break;
-            case TransactionHistoryModel::TransactionAmountRole:
-            {
-                double from = amountFromFilter();
-                double to = amountToFilter();
-                double amount = data.toDouble();
-
-                bool matchFrom = from <= 0 || amount  >= from;
-                bool matchTo = to <= 0 || amount <= to;
-                result = matchFrom && matchTo;
-            }
-                break;
-            case TransactionHistoryModel::TransactionDirectionRole:
-                result = directionFilter() == TransactionInfo::Direction_Both ? true
-                                                  : data.toInt() == directionFilter();
+    return paymentId.isEmpty() || txs.paymentId(row).contains(paymentId);
+}
 
+TransactionHistory *TransactionHistorySortFilterModel::transactionHistory() const
+{
+    const TransactionHistoryModel * model = static_cast<const TransactionHistoryModel*> (sourceModel());
+    return model->transactionHistory();
+}
 
-                break;
+QVariantMap TransactionHistorySortFilterModel::queryPage(const QVariantMap &filter, int sortRole, bool descending, int page, int pageSize)
+{
+    QVariantMap result;
+    const TransactionHistoryModel * model = static_cast<const TransactionHistoryModel*> (sourceModel());
+    if (!model || !model->transactionHistory() || pageSize <= 0) {
+        result.insert("total", 0);
+        result.insert("page", 0);
+        result.insert("rows", QVariantList());
+        result.insert("pending", false);
+        return result;
+    }
 
-            default:
-                break;
+    const std::shared_ptr<const TransactionStore> snapshot = model->transactionHistory()->snapshot();
+    const TransactionStore &txs = *snapshot;
+    const QString search = filter.value("search").toString();
+    FilterPredicate dates;
+    dates.setDates(filter.value("dateFrom").toDate(), filter.value("dateTo").toDate());
+
+    QVector<int> rows;
+    bool pending = false;
+    if (search.isEmpty()) {
+        rows.resize(txs.size());
+        std::iota(rows.begin(), rows.end(), 0);
+    } else {
+        const QSharedPointer<const TransactionSearchIndex> index = searchIndex();
+        pending = !m_searchIndexCurrent;
+        if (index) {
+            rows = index->search(search);
+            // rows newer than the index are shown until the rebuilt one says otherwise
+            for (int row = index->size(); row < txs.size(); ++row) {
+                rows.append(row);
             }
-
-
-            if (!result) { // stop the loop once filter doesn't match
-                break;
+        }
+    }
+    rows.erase(std::remove_if(rows.begin(), rows.end(), [&txs, &dates](int row) {
+        return row >= txs.size() || !dates.acceptsTimestamp(txs.timestamp(row));
+    }), rows.end());
+
+    std::stable_sort(rows.begin(), rows.end(), [&txs, sortRole, descending](int left, int right) {
+        const quint64 leftKey = sortKey(txs, left, sortRole);
+        const quint64 rightKey = sortKey(txs, right, sortRole);
+        return descending ? rightKey < leftKey : leftKey < rightKey;
+    });
+
+    const int lastPage = rows.isEmpty() ? 0 : (rows.size() - 1) / pageSize;
+    page = qBound(0, page, lastPage);
+
+    // formatting goes through the source model so its display cache is shared with the views
+    const QHash<int, QByteArray> roles = model->roleNames();
+    QVariantList pageRows;
+    const int end = std::min(rows.size(), (page + 1) * pageSize);
+    for (int i = page * pageSize; i < end; ++i) {
+        const QModelIndex index = model->index(rows[i], 0);
+        QVariantMap values;
+        values.insert("row", rows[i]);
+        for (auto it = roles.constBegin(); it != roles.constEnd(); ++it) {
+            if (it.key() > Qt::UserRole) {
+                values.insert(QString::fromUtf8(it.value()), model->data(index, it.key()));
             }
         }
+        pageRows.append(values);
+    }
+
+    result.insert("total", rows.size());
+    result.insert("page", page);
+    result.insert("rows", pageRows);
+    result.insert("pending", pending);
+    return result;
+}
+
+bool TransactionHistorySortFilterModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+{
+    Q_UNUSED(source_parent)
+
+    if (source_row < 0 || source_row >= sourceModel()->rowCount()) {
+        return false;
     }
 
+    const std::shared_ptr<const TransactionStore> txs = transactionHistory()->snapshot();
+    bool result = source_row < txs->size() && m_predicate.accepts(*txs, source_row);
+
     if (!result || m_searchString.isEmpty())
         return result;
 
-    QVariant data = sourceModel()->data(index, TransactionHistoryModel::TransactionPaymentIdRole);
-    if (data.toString().contains(m_searchString))
-        return true;
-    data = sourceModel()->data(index, TransactionHistoryModel::TransactionDisplayAmountRole);
-    if (data.toString().contains(m_searchString))
-        return true;
-    data = sourceModel()->data(index, TransactionHistoryModel::TransactionBlockHeightRole);
-    if (data.toString().contains(m_searchString))
-        return true;
-    data = sourceModel()->data(index, TransactionHistoryModel::TransactionFeeRole);
-    if (data.toString().contains(m_searchString))
-        return true;
-    data = sourceModel()->data(index, TransactionHistoryModel::TransactionHashRole);
-    if (data.toString().contains(m_searchString))
-        return true;
-    data = sourceModel()->data(index, TransactionHistoryModel::TransactionDateRole);
-    if (data.toString().contains(m_searchString))
-        return true;
-    data = sourceModel()->data(index, TransactionHistoryModel::TransactionTimeRole);
-    if (data.toString().contains(m_searchString))
-        return true;
-    data = sourceModel()->data(index, TransactionHistoryModel::TransactionDestinationsRole);
-    if (data.toString().contains(m_searchString))
-        return true;
-
-    return false;
+    // rows newer than the last search are shown until the next result lands
+    return source_row >= m_searchMatches.size() || m_searchMatches[source_row];
 }
 
 bool TransactionHistorySortFilterModel::lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const
 {
     return QSortFilterProxyModel::lessThan(source_left, source_right);
 }
+
+void TransactionHistorySortFilterModel::onSourceReset()
+{
+    invalidateSearchIndex();
+}
+
+void TransactionHistorySortFilterModel::onSourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent)
+    if (first <= m_searchMatches.size()) {
+        // not searched yet, shown until the rebuilt index says otherwise
+        m_searchMatches.insert(first, last - first + 1, true);
+    }
+    invalidateSearchIndex();
+}
+
+void TransactionHistorySortFilterModel::onSourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent)
+    if (first < m_searchMatches.size()) {
+        m_searchMatches.remove(first, std::min(last + 1, m_searchMatches.size()) - first);
+    }
+    invalidateSearchIndex();
+}
+
+void TransactionHistorySortFilterModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    Q_UNUSED(topLeft)
+    Q_UNUSED(bottomRight)
+    // confirmations aren't searchable
+    if (roles.size() == 1 && roles.first() == TransactionHistoryModel::TransactionConfirmationsRole) {
+        return;
+    }
+    invalidateSearchIndex();
+}
+
+void TransactionHistorySortFilterModel::invalidateSearchIndex()
+{
+    m_searchIndexCurrent = false;
+    ++m_sourceGeneration;
+    ++m_searchGeneration;
+    if (!m_searchString.isEmpty()) {
+        scheduleSearch();
+    }
+}
+
+void TransactionHistorySortFilterModel::scheduleSearch()
+{
+    if (!sourceModel()) {
+        return;
+    }
+
+    const quint64 generation = ++m_searchGeneration;
+    const QSharedPointer<const TransactionSearchIndex> index = m_searchIndexCurrent ? m_searchIndex : QSharedPointer<const TransactionSearchIndex>();
+    // only needed when there's no index to search
+    const std::shared_ptr<const TransactionStore> snapshot = index ? nullptr : transactionHistory()->snapshot();
+    const QString query = m_searchString;
+    const TransactionSearchIndex::Annotator annotator = m_annotator;
+
+    m_scheduler.run([this, generation, index, snapshot, query, annotator] {
+        SearchResult result;
+        result.generation = generation;
+        result.index = index ? index : QSharedPointer<const TransactionSearchIndex>(new TransactionSearchIndex(*snapshot, annotator));
+        result.matches.fill(false, result.index->size());
+        for (int row : result.index->search(query)) {
+            result.matches[row] = true;
+        }
+
+        {
+            QMutexLocker locker(&m_searchMutex);
+            if (generation < m_searchResult.generation) {
+                return;
+            }
+            m_searchResult = result;
+        }
+        emit searchFinished();
+    }, FutureScheduler::Lane::Interactive);
+}
+
+void TransactionHistorySortFilterModel::onSearchFinished()
+{
+    SearchResult result;
+    {
+        QMutexLocker locker(&m_searchMutex);
+        result = m_searchResult;
+    }
+
+    // the source or the search string changed in the meantime, a newer search is on its way
+    if (result.generation != m_searchGeneration) {
+        return;
+    }
+
+    // no source change since the search was scheduled, so its index is current
+    if (!m_searchIndexCurrent) {
+        m_searchIndex = result.index;
+        m_searchIndexCurrent = true;
+        emit searchIndexReady();
+    }
+    m_searchMatches = result.matches;
+    invalidateFilter();
+}
+
+void TransactionHistorySortFilterModel::scheduleSearchIndex()
+{
+    if (m_searchIndexBuilding || !sourceModel()) {
+        return;
+    }
+    m_searchIndexBuilding = true;
+
+    const quint64 generation = m_sourceGeneration;
+    const std::shared_ptr<const TransactionStore> snapshot = transactionHistory()->snapshot();
+    const TransactionSearchIndex::Annotator annotator = m_annotator;
+
+    // the annotator calls into the wallet for every row, far too slow for the GUI thread
+    m_scheduler.run([this, generation, snapshot, annotator] {
+        SearchResult result;
+        result.generation = generation;
+        result.index.reset(new TransactionSearchIndex(*snapshot, annotator));
+        {
+            QMutexLocker locker(&m_searchMutex);
+            m_builtIndex = result;
+        }
+        emit searchIndexBuilt();
+    }, FutureScheduler::Lane::Background, FutureScheduler::Priority_Normal, "search index");
+}
+
+void TransactionHistorySortFilterModel::onSearchIndexBuilt()
+{
+    SearchResult result;
+    {
+        QMutexLocker locker(&m_searchMutex);
+        result = m_builtIndex;
+    }
+    m_searchIndexBuilding = false;
+
+    // a search may have installed a newer index in the meantime
+    if (m_searchIndexCurrent) {
+        return;
+    }
+    m_searchIndex = result.index;
+    if (result.generation != m_sourceGeneration) {
+        // the rows changed during the build, searched as they were until the next build lands
+        scheduleSearchIndex();
+        return;
+    }
+    m_searchIndexCurrent = true;
+    emit searchIndexReady();
+}
+
+QSharedPointer<const TransactionSearchIndex> TransactionHistorySortFilterModel::searchIndex()
+{
+    if (!m_searchIndexCurrent) {
+        scheduleSearchIndex();
+    }
+    return m_searchIndex;
+}
@@ -30,14 +30,23 @@
 #define TRANSACTIONHISTORYSORTFILTERMODEL_H
 
 #include "TransactionInfo.h"
+#include "TransactionSearchIndex.h"
+#include "qt/FutureScheduler.h"
 
 #include <QSortFilterProxyModel>
 #include <QMap>
+#include <QMutex>
+#include <QSharedPointer>
 #include <QVariant>
+#include <QVariantMap>
+#include <QVector>
 #include <QDate>
 
+#include <limits>
+
 
 class TransactionHistory;
+class TransactionStore;
 
 class TransactionHistorySortFilterModel: public QSortFilterProxyModel
 {
@@ -54,7 +63,21 @@ class TransactionHistorySortFilterModel: public QSortFilterProxyModel
 
 public:
     TransactionHistorySortFilterModel(QObject * parent = nullptr);
-    //! filtering by string search
+    ~TransactionHistorySortFilterModel();
+
+    // QAbstractProxyModel override, tracks source changes to keep the search index current
+    virtual void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    //! waits for the search workers, whatever the annotator uses must stay alive until this returns
+    void shutdown();
+
+    //! makes the annotator's fields searchable, it's called on worker threads
+    void setSearchAnnotator(TransactionSearchIndex::Annotator annotator);
+    //! rebuilds the search index once the fields the annotator returns have changed
+    void invalidateAnnotations();
+
+    //! filtering by string search, matches are looked up in a search index off the GUI thread
+    //! and applied once they arrive
     QString searchFilter() const;
     void setSearchFilter(const QString &arg);
 
@@ -85,6 +108,23 @@ public:
     Q_INVOKABLE void sort(int column, Qt::SortOrder order);
     TransactionHistory * transactionHistory() const;
 
+    /**
+     * @brief queryPage - filters and sorts the shown account's history and formats a single page of it
+     * @param filter - "search" string, "dateFrom" and "dateTo" dates (inclusive), missing keys disable the filter
+     * @param sortRole - TransactionBlockHeightRole, TransactionTimeStampRole or TransactionAmountRole
+     * @param descending - sort order
+     * @param page - zero-based page number, clamped to the last page
+     * @param pageSize - rows per page
+     * @return map with the "total" number of matching rows, the clamped "page" and the page "rows",
+     *         each row keyed by role names plus its model "row", and "pending" while a search is
+     *         answered from an outdated index
+     *
+     * Works on the history columns directly, the proxy's own filters and sort order are left untouched.
+     * The search index is built off the GUI thread, until it's current the last built one is searched
+     * and searchIndexReady() is emitted once the query is worth repeating.
+     */
+    Q_INVOKABLE QVariantMap queryPage(const QVariantMap &filter, int sortRole, bool descending, int page, int pageSize);
+
 signals:
     void searchFilterChanged();
     void paymentIdFilterChanged();
@@ -93,6 +133,12 @@ signals:
     void amountFromFilterChanged();
     void amountToFilterChanged();
     void directionFilterChanged();
+    //! emitted by the search worker, the result is picked up on the model's thread
+    void searchFinished();
+    //! emitted by the index worker, the index is picked up on the model's thread
+    void searchIndexBuilt();
+    //! a search index for the current rows is in place, pending queryPage() searches can be repeated
+    void searchIndexReady();
 
 protected:
     // QSortFilterProxyModel overrides
@@ -100,15 +146,70 @@ protected:
     virtual bool lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const;
 
 
+private slots:
+    void onSourceReset();
+    void onSourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void onSourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    void onSearchFinished();
+    void onSearchIndexBuilt();
+
 private:
     enum ScopeIndex {
         From = 0,
         To   = 1
     };
 
+    struct SearchResult {
+        quint64 generation = 0;
+        QSharedPointer<const TransactionSearchIndex> index;
+        QVector<bool> matches;
+    };
+
+    // filter values compiled into bounds on the raw history columns, rebuilt whenever one changes
+    struct FilterPredicate {
+        qint64 timestampFrom = std::numeric_limits<qint64>::min();
+        // exclusive
+        qint64 timestampTo = std::numeric_limits<qint64>::max();
+        quint64 amountFrom = 0;
+        quint64 amountTo = std::numeric_limits<quint64>::max();
+        int direction = TransactionInfo::Direction_Both;
+        QString paymentId;
+
+        //! whole local days from dateFrom to dateTo, an invalid date leaves its side open
+        void setDates(const QDate &dateFrom, const QDate &dateTo);
+        bool acceptsTimestamp(qint64 timestamp) const;
+        bool accepts(const TransactionStore &txs, int row) const;
+    };
+
+    void compileFilter();
+    void invalidateSearchIndex();
+    void scheduleSearch();
+    void scheduleSearchIndex();
+    //! the last built index, a build for the current source rows is scheduled if it's outdated
+    QSharedPointer<const TransactionSearchIndex> searchIndex();
+
 private:
     QMap<int, QVariant> m_filterValues;
+    FilterPredicate m_predicate;
     QString m_searchString;
+    TransactionSearchIndex::Annotator m_annotator;
+
+    // the last built index, outdated while the source changed since
+    QSharedPointer<const TransactionSearchIndex> m_searchIndex;
+    bool m_searchIndexCurrent;
+    bool m_searchIndexBuilding;
+    // bumped on every source change, an index built from older rows is outdated
+    quint64 m_sourceGeneration;
+    // source rows matching m_searchString, as of the last finished search
+    QVector<bool> m_searchMatches;
+    // bumped on every search request and source change, older results are dropped
+    quint64 m_searchGeneration;
+    QMutex m_searchMutex;
+    SearchResult m_searchResult;
+    // generation is the source generation the index was built for
+    SearchResult m_builtIndex;
+    FutureScheduler m_scheduler;
 };
 
 #endif // TRANSACTIONHISTORYSORTFILTERMODEL_H
@@ -0,0 +1,165 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "TransactionSearchIndex.h"
+#include "TransactionStore.h"
+#include "WalletManager.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <numeric>
+
+#include <QByteArrayMatcher>
+#include <QDateTime>
+
+TransactionSearchIndex::TransactionSearchIndex()
+{
+}
+
+TransactionSearchIndex::TransactionSearchIndex(const TransactionStore &txs, const Annotator &annotate /* = Annotator() */)
+{
+    m_rowOffsets.reserve(txs.size() + 1);
+    m_tokens.reserve(txs.size() * 10);
+
+    for (int row = 0; row < txs.size(); ++row) {
+        m_rowOffsets.append(m_text.size());
+
+        const QDateTime timestamp = QDateTime::fromSecsSinceEpoch(txs.timestamp(row));
+        addField(row, txs.paymentId(row));
+        addField(row, WalletManager::displayAmount(txs.amount(row)));
+        if (txs.fee(row) != 0) {
+            addField(row, WalletManager::displayAmount(txs.fee(row)));
+        }
+        if (txs.blockHeight(row) != 0) {
+            addField(row, QString::number(txs.blockHeight(row)));
+        }
+        addField(row, txs.hash(row));
+        addField(row, timestamp.date().toString(Qt::ISODate));
+        addField(row, timestamp.time().toString(Qt::ISODate));
+        for (int i = 0; i < txs.transferCount(row); ++i) {
+            addField(row, WalletManager::displayAmount(txs.transferAmount(row, i)));
+            addField(row, txs.transferAddress(row, i));
+        }
+        addField(row, txs.label(row));
+        addField(row, txs.description(row));
+        if (annotate) {
+            for (const QString &field : annotate(txs, row)) {
+                addField(row, field);
+            }
+        }
+    }
+    m_rowOffsets.append(m_text.size());
+
+    const char *text = m_text.constData();
+    std::sort(m_tokens.begin(), m_tokens.end(), [text](const Token &left, const Token &right) {
+        const int cmp = std::memcmp(text + left.offset, text + right.offset, std::min(left.length, right.length));
+        return cmp != 0 ? cmp < 0 : left.length < right.length;
+    });
+}
+
+int TransactionSearchIndex::size() const
+{
+    return m_rowOffsets.isEmpty() ? 0 : m_rowOffsets.size() - 1;
+}
+
+QVector<int> TransactionSearchIndex::search(const QString &query) const
+{
+    const QByteArray needle = query.trimmed().toLower().toUtf8();
+    if (needle.isEmpty()) {
+        QVector<int> rows(size());
+        std::iota(rows.begin(), rows.end(), 0);
+        return rows;
+    }
+
+    for (const char c : needle) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            return scan(needle);
+        }
+    }
+
+    // tokens prefixed by the needle are contiguous, starting at the first one not less than it
+    const char *text = m_text.constData();
+    auto it = std::lower_bound(m_tokens.constBegin(), m_tokens.constEnd(), needle, [text](const Token &token, const QByteArray &value) {
+        const int cmp = std::memcmp(text + token.offset, value.constData(), std::min(token.length, value.size()));
+        return cmp != 0 ? cmp < 0 : token.length < value.size();
+    });
+
+    QVector<int> rows;
+    for (; it != m_tokens.constEnd(); ++it) {
+        if (it->length < needle.size() || std::memcmp(text + it->offset, needle.constData(), needle.size()) != 0) {
+            break;
+        }
+        rows.append(it->row);
+    }
+
+    // no word starts with it, e.g. a fragment from the middle of a hash
+    if (rows.isEmpty()) {
+        return scan(needle);
+    }
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return rows;
+}
+
+void TransactionSearchIndex::addField(int row, const QString &field)
+{
+    if (field.isEmpty()) {
+        return;
+    }
+
+    const QByteArray bytes = field.toLower().toUtf8();
+    int start = -1;
+    for (int i = 0; i <= bytes.size(); ++i) {
+        const bool blank = i == bytes.size() || std::isspace(static_cast<unsigned char>(bytes[i]));
+        if (!blank && start < 0) {
+            start = i;
+        } else if (blank && start >= 0) {
+            m_tokens.append({m_text.size() + start, i - start, row});
+            start = -1;
+        }
+    }
+    m_text.append(bytes);
+    m_text.append('\n');
+}
+
+QVector<int> TransactionSearchIndex::scan(const QByteArray &needle) const
+{
+    QVector<int> rows;
+    const QByteArrayMatcher matcher(needle);
+    int from = 0;
+    int position;
+    while ((position = matcher.indexIn(m_text, from)) >= 0) {
+        const auto next = std::upper_bound(m_rowOffsets.constBegin(), m_rowOffsets.constEnd(), position);
+        rows.append(static_cast<int>(next - m_rowOffsets.constBegin()) - 1);
+        // one hit per row is enough
+        from = *next;
+    }
+    return rows;
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef TRANSACTIONSEARCHINDEX_H
+#define TRANSACTIONSEARCHINDEX_H
+
+#include <functional>
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class TransactionStore;
+
+/**
+ * @brief The TransactionSearchIndex class - immutable full-text index over a TransactionStore snapshot
+ *
+ * Every row is rendered once into a lowercase haystack holding its payment id, amount, fee,
+ * block height, hash, date, time, destinations, label and description, plus whatever the
+ * annotator adds. The haystack words are kept in a sorted token table, so a query is a binary
+ * search for the tokens it prefixes. Queries containing blanks, or prefixing no token at all, fall
+ * back to a substring scan of the haystacks. Building and searching don't touch shared state, any
+ * thread may do either as long as the annotator allows it.
+ */
+class TransactionSearchIndex
+{
+public:
+    //! extra searchable fields of a row that the store doesn't hold, like address book names
+    using Annotator = std::function<QStringList(const TransactionStore &txs, int row)>;
+
+    TransactionSearchIndex();
+    explicit TransactionSearchIndex(const TransactionStore &txs, const Annotator &annotate = Annotator());
+
+    //! number of indexed rows
+    int size() const;
+
+    //! ascending rows with a token starting with the query, or else containing it, case insensitive
+    QVector<int> search(const QString &query) const;
+
+private:
+    struct Token {
+        int offset;
+        int length;
+        int row;
+    };
+
+    void addField(int row, const QString &field);
+    QVector<int> scan(const QByteArray &needle) const;
+
+private:
+    // haystacks of all rows, words separated by blanks and fields by new lines
+    QByteArray m_text;
+    // start of every row's haystack, followed by the end of the last one
+    QVector<int> m_rowOffsets;
+    // words of m_text ordered by their bytes
+    QVector<Token> m_tokens;
+};
+
+#endif // TRANSACTIONSEARCHINDEX_H
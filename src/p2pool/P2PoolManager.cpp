@@ -117,7 +117,7 @@ void P2PoolManager::download() {
                 }
             }
         }
-    });
+    }, FutureScheduler::Lane::Dedicated);
     return;
 }
 
@@ -1,16 +1,104 @@
 #include "FutureScheduler.h"
 
-#include <mutex>
+#include <algorithm>
+#include <memory>
 
-#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QFutureInterface>
+#include <QRunnable>
+
+#include "SchedulerTelemetry.h"
+
+namespace
+{
+
+class FunctionRunnable : public QRunnable
+{
+public:
+    FunctionRunnable(const QString &lane, const QString &name, std::function<void()> function)
+        : Lane(lane), Name(name), Function(std::move(function))
+    {
+        setAutoDelete(true);
+        SchedulerTelemetry::instance().taskQueued(Lane);
+        Queued.start();
+    }
+
+    void run() override
+    {
+        SchedulerTelemetry &telemetry = SchedulerTelemetry::instance();
+        telemetry.taskStarted(Lane, Name, Queued.elapsed());
+
+        QElapsedTimer running;
+        running.start();
+        Function();
+        telemetry.taskFinished(Lane, Name, running.elapsed());
+    }
+
+private:
+    const QString Lane;
+    const QString Name;
+    std::function<void()> Function;
+    QElapsedTimer Queued;
+};
+
+// token of the task running on this thread
+thread_local const CancellationToken *CurrentToken = nullptr;
+
+class CurrentTokenGuard
+{
+public:
+    explicit CurrentTokenGuard(const CancellationToken &token)
+        : Previous(CurrentToken)
+    {
+        CurrentToken = &token;
+    }
+
+    ~CurrentTokenGuard()
+    {
+        CurrentToken = Previous;
+    }
+
+private:
+    const CancellationToken *Previous;
+};
+
+QThreadPool *makePool(int maxThreadCount)
+{
+    // Intentionally leaked, tasks may still be finishing while static destructors run.
+    QThreadPool *pool = new QThreadPool();
+    pool->setMaxThreadCount(maxThreadCount);
+    return pool;
+}
+
+} // namespace
+
+CancellationToken::CancellationToken()
+    : CancellationToken(nullptr)
+{
+}
+
+CancellationToken::CancellationToken(std::shared_ptr<std::atomic<bool>> scope)
+    : Cancelled(std::make_shared<std::atomic<bool>>(false)), Scope(std::move(scope))
+{
+}
+
+void CancellationToken::cancel() const noexcept
+{
+    *Cancelled = true;
+}
+
+bool CancellationToken::isCancelled() const noexcept
+{
+    return *Cancelled || (Scope && *Scope);
+}
 
 FutureScheduler::FutureScheduler(QObject *parent)
-    : QObject(parent), Alive(0), Stopping(false)
+    : QObject(parent)
+    , Owner(parent != nullptr ? parent->metaObject()->className() : "FutureScheduler")
+    , Alive(0)
+    , Stopping(false)
+    , Scope(std::make_shared<std::atomic<bool>>(false))
 {
-    static std::once_flag once;
-    std::call_once(once, []() {
-        QThreadPool::globalInstance()->setMaxThreadCount(4);
-    });
 }
 
 FutureScheduler::~FutureScheduler()
@@ -23,16 +111,25 @@ void FutureScheduler::shutdownWaitForFinished() noexcept
     QMutexLocker locker(&Mutex);
 
     Stopping = true;
+    *Scope = true;
     while (Alive > 0)
     {
         Condition.wait(&Mutex);
     }
 }
 
-QPair<bool, QFuture<void>> FutureScheduler::run(std::function<void()> function) noexcept
+void FutureScheduler::cancelAll() noexcept
+{
+    QMutexLocker locker(&Mutex);
+
+    *Scope = true;
+    Scope = std::make_shared<std::atomic<bool>>(false);
+}
+
+ScheduledTask<void> FutureScheduler::run(std::function<void()> function, Lane lane, int priority, const QString &name) noexcept
 {
-    return execute<void>([this, function](QFutureWatcher<void> *) {
-        return QtConcurrent::run([this, function] {
+    return execute<void>([this, function, lane, priority, name](QFutureWatcher<void> *, const CancellationToken &token) {
+        return start(lane, priority, taskName(name), token, [this, function] {
             try
             {
                 function();
@@ -46,18 +143,26 @@ QPair<bool, QFuture<void>> FutureScheduler::run(std::function<void()> function)
     });
 }
 
-QPair<bool, QFuture<QJSValueList>> FutureScheduler::run(std::function<QJSValueList()> function, const QJSValue &callback)
+ScheduledTask<QJSValueList> FutureScheduler::run(
+    std::function<QJSValueList()> function,
+    const QJSValue &callback,
+    Lane lane,
+    int priority,
+    const QString &name)
 {
     if (!callback.isCallable())
     {
         throw std::runtime_error("js callback must be callable");
     }
 
-    return execute<QJSValueList>([this, function, callback](QFutureWatcher<QJSValueList> *watcher) {
-        connect(watcher, &QFutureWatcher<QJSValueList>::finished, [watcher, callback] {
-            QJSValue(callback).call(watcher->future().result());
+    return execute<QJSValueList>([this, function, callback, lane, priority, name](QFutureWatcher<QJSValueList> *watcher, const CancellationToken &token) {
+        connect(watcher, &QFutureWatcher<QJSValueList>::finished, [watcher, callback, token] {
+            if (!token.isCancelled())
+            {
+                QJSValue(callback).call(watcher->future().result());
+            }
         });
-        return QtConcurrent::run([this, function] {
+        return startWithResult(lane, priority, taskName(name), token, [this, function] {
             QJSValueList result;
             try
             {
@@ -73,12 +178,177 @@ QPair<bool, QFuture<QJSValueList>> FutureScheduler::run(std::function<QJSValueLi
     });
 }
 
+bool FutureScheduler::runKeyed(const QString &key, std::function<void()> function, Lane lane, int priority) noexcept
+{
+    {
+        QMutexLocker locker(&KeyedMutex);
+
+        const auto it = Keyed.find(key);
+        if (it != Keyed.end())
+        {
+            // the key's drain task picks this up once it is free
+            it.value() = std::move(function);
+            return true;
+        }
+        Keyed.insert(key, std::move(function));
+    }
+
+    if (!run([this, key] { drainKeyed(key); }, lane, priority, key).first)
+    {
+        QMutexLocker locker(&KeyedMutex);
+        Keyed.remove(key);
+        return false;
+    }
+    return true;
+}
+
+void FutureScheduler::drainKeyed(const QString &key) noexcept
+{
+    while (true)
+    {
+        std::function<void()> function;
+        {
+            QMutexLocker locker(&KeyedMutex);
+
+            const auto it = Keyed.find(key);
+            if (it == Keyed.end())
+            {
+                return;
+            }
+            if (!it.value() || Stopping)
+            {
+                Keyed.erase(it);
+                return;
+            }
+            // an empty function marks the key as running without a follow-up
+            function = std::move(it.value());
+            it.value() = nullptr;
+        }
+
+        try
+        {
+            function();
+        }
+        catch (const std::exception &exception)
+        {
+            qWarning() << "Exception thrown from async function: " << exception.what();
+        }
+    }
+}
+
 bool FutureScheduler::stopping() const noexcept
 {
     return Stopping;
 }
 
-bool FutureScheduler::add() noexcept
+bool FutureScheduler::cancelled() noexcept
+{
+    return CurrentToken != nullptr && CurrentToken->isCancelled();
+}
+
+void FutureScheduler::setLaneThreadCount(Lane lane, int threads)
+{
+    pool(lane)->setMaxThreadCount(std::max(1, threads));
+}
+
+int FutureScheduler::laneThreadCount(Lane lane)
+{
+    return pool(lane)->maxThreadCount();
+}
+
+QString FutureScheduler::laneName(Lane lane)
+{
+    switch (lane)
+    {
+    case Lane::Interactive:
+        return "interactive";
+    case Lane::Dedicated:
+        return "dedicated";
+    case Lane::Background:
+    default:
+        return "background";
+    }
+}
+
+QString FutureScheduler::taskName(const QString &name) const
+{
+    return name.isEmpty() ? Owner : Owner + "::" + name;
+}
+
+QThreadPool *FutureScheduler::pool(Lane lane)
+{
+    switch (lane)
+    {
+    case Lane::Interactive:
+    {
+        static QThreadPool *const interactive = makePool(2);
+        return interactive;
+    }
+    case Lane::Dedicated:
+    {
+        // Bounded only as a safety net, idle threads expire after the default 30 seconds.
+        static QThreadPool *const dedicated = makePool(32);
+        return dedicated;
+    }
+    case Lane::Background:
+    default:
+    {
+        static QThreadPool *const background = [] {
+            QThreadPool::globalInstance()->setMaxThreadCount(4);
+            return QThreadPool::globalInstance();
+        }();
+        return background;
+    }
+    }
+}
+
+QFuture<void> FutureScheduler::start(
+    Lane lane,
+    int priority,
+    const QString &name,
+    const CancellationToken &token,
+    std::function<void()> function)
+{
+    auto promise = std::make_shared<QFutureInterface<void>>();
+    promise->reportStarted();
+    QFuture<void> future = promise->future();
+
+    pool(lane)->start(new FunctionRunnable(laneName(lane), name, [promise, token, function] {
+        {
+            CurrentTokenGuard guard(token);
+            function();
+        }
+        promise->reportFinished();
+    }), priority);
+
+    return future;
+}
+
+QFuture<QJSValueList> FutureScheduler::startWithResult(
+    Lane lane,
+    int priority,
+    const QString &name,
+    const CancellationToken &token,
+    std::function<QJSValueList()> function)
+{
+    auto promise = std::make_shared<QFutureInterface<QJSValueList>>();
+    promise->reportStarted();
+    QFuture<QJSValueList> future = promise->future();
+
+    pool(lane)->start(new FunctionRunnable(laneName(lane), name, [promise, token, function] {
+        QJSValueList result;
+        {
+            CurrentTokenGuard guard(token);
+            result = function();
+        }
+        promise->reportResult(result);
+        promise->reportFinished();
+    }), priority);
+
+    return future;
+}
+
+bool FutureScheduler::add(CancellationToken &token) noexcept
 {
     QMutexLocker locker(&Mutex);
 
@@ -87,6 +357,7 @@ bool FutureScheduler::add() noexcept
         return false;
     }
 
+    token = CancellationToken(Scope);
     ++Alive;
     return true;
 }
@@ -1,38 +1,140 @@
 #ifndef FUTURE_SCHEDULER_H
 #define FUTURE_SCHEDULER_H
 
+#include <atomic>
 #include <functional>
+#include <memory>
 
 #include <QtConcurrent/QtConcurrent>
 #include <QFuture>
+#include <QHash>
 #include <QJSValue>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QPair>
+#include <QThreadPool>
 #include <QWaitCondition>
 
+// Shared cancellation flag of a scheduled task, cheap to copy. Cancelling never interrupts a task,
+// the task polls FutureScheduler::cancelled() and returns early.
+class CancellationToken
+{
+public:
+    CancellationToken();
+
+    void cancel() const noexcept;
+    bool isCancelled() const noexcept;
+
+private:
+    friend class FutureScheduler;
+    explicit CancellationToken(std::shared_ptr<std::atomic<bool>> scope);
+
+    std::shared_ptr<std::atomic<bool>> Cancelled;
+    // set when the owning scheduler cancels all of its tasks
+    std::shared_ptr<std::atomic<bool>> Scope;
+};
+
+// Result of FutureScheduler::run(), first is false if the task was not scheduled.
+template<typename T>
+struct ScheduledTask : public QPair<bool, QFuture<T>>
+{
+    ScheduledTask(bool scheduled, const QFuture<T> &future, const CancellationToken &token)
+        : QPair<bool, QFuture<T>>(scheduled, future), token(token)
+    {
+    }
+
+    CancellationToken token;
+};
+
 class FutureScheduler : public QObject
 {
     Q_OBJECT
 
 public:
+    // Each lane is a separate thread pool, so slow work in one lane never delays tasks queued in another.
+    enum class Lane
+    {
+        // short user-facing calls whose result the UI waits for
+        Interactive,
+        // sync and bookkeeping work, shares the global thread pool
+        Background,
+        // tasks that block or sleep for a long time, each gets its own thread
+        Dedicated,
+    };
+
+    // Within a lane, queued tasks with a higher priority start first.
+    enum Priority
+    {
+        Priority_Low = -1,
+        Priority_Normal = 0,
+        Priority_High = 1,
+    };
+
     FutureScheduler(QObject *parent);
     ~FutureScheduler();
 
+    // Cancels the outstanding tasks and waits for them to return.
     void shutdownWaitForFinished() noexcept;
+    // Cancels every task scheduled so far, later tasks are not affected.
+    void cancelAll() noexcept;
 
-    QPair<bool, QFuture<void>> run(std::function<void()> function) noexcept;
-    QPair<bool, QFuture<QJSValueList>> run(std::function<QJSValueList()> function, const QJSValue &callback);
+    // Tasks are named in the scheduler telemetry, unnamed tasks by the class of the scheduler's parent.
+    ScheduledTask<void> run(
+        std::function<void()> function,
+        Lane lane = Lane::Background,
+        int priority = Priority_Normal,
+        const QString &name = QString()) noexcept;
+    // Runs at most one task per key at a time. A submission replaces a task of the same key that
+    // has not started yet, while a task of the key is running the latest submission runs once after it.
+    // All of them run on the lane and priority of the submission that found the key idle, later
+    // submissions with another lane or a higher priority don't move it, so a key should always be
+    // submitted with the same ones. Returns false if the scheduler is stopping.
+    bool runKeyed(
+        const QString &key,
+        std::function<void()> function,
+        Lane lane = Lane::Background,
+        int priority = Priority_Normal) noexcept;
+    // The callback is not called if the task gets cancelled.
+    ScheduledTask<QJSValueList> run(
+        std::function<QJSValueList()> function,
+        const QJSValue &callback,
+        Lane lane = Lane::Interactive,
+        int priority = Priority_Normal,
+        const QString &name = QString());
     bool stopping() const noexcept;
+    // Whether the task running on the calling thread was cancelled, false outside of scheduled tasks.
+    static bool cancelled() noexcept;
+
+    // Changes the maximum number of threads of a lane, applies to all schedulers.
+    static void setLaneThreadCount(Lane lane, int threads);
+    static int laneThreadCount(Lane lane);
+    static QString laneName(Lane lane);
 
 private:
-    bool add() noexcept;
+    bool add(CancellationToken &token) noexcept;
     void done() noexcept;
+    void drainKeyed(const QString &key) noexcept;
+    QString taskName(const QString &name) const;
+
+    static QThreadPool *pool(Lane lane);
+    static QFuture<void> start(
+        Lane lane,
+        int priority,
+        const QString &name,
+        const CancellationToken &token,
+        std::function<void()> function);
+    static QFuture<QJSValueList> startWithResult(
+        Lane lane,
+        int priority,
+        const QString &name,
+        const CancellationToken &token,
+        std::function<QJSValueList()> function);
 
     template<typename T>
-    QPair<bool, QFuture<T>> execute(std::function<QFuture<T>(QFutureWatcher<T> *)> makeFuture) noexcept
+    ScheduledTask<T> execute(std::function<QFuture<T>(QFutureWatcher<T> *, const CancellationToken &)> makeFuture) noexcept
     {
-        if (add())
+        CancellationToken token;
+        if (add(token))
         {
             try
             {
@@ -40,8 +142,8 @@ private:
                 connect(watcher, &QFutureWatcher<T>::finished, [watcher] {
                     watcher->deleteLater();
                 });
-                watcher->setFuture(makeFuture(watcher));
-                return qMakePair(true, watcher->future());
+                watcher->setFuture(makeFuture(watcher, token));
+                return ScheduledTask<T>(true, watcher->future(), token);
             }
             catch (const std::exception &exception)
             {
@@ -50,14 +152,19 @@ private:
             }
         }
 
-        return qMakePair(false, QFuture<T>());
+        return ScheduledTask<T>(false, QFuture<T>(), token);
     }
 
 private:
+    const QString Owner;
     size_t Alive;
     QWaitCondition Condition;
     QMutex Mutex;
     std::atomic<bool> Stopping;
+    std::shared_ptr<std::atomic<bool>> Scope;
+    // latest not yet started submission of each key that has a drain task scheduled
+    QHash<QString, std::function<void()>> Keyed;
+    QMutex KeyedMutex;
 };
 
 #endif // FUTURE_SCHEDULER_H
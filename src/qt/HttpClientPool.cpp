@@ -0,0 +1,214 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "HttpClientPool.h"
+
+#include <algorithm>
+
+#include <QDebug>
+
+#include "FutureScheduler.h"
+
+namespace
+{
+// bounds both the sockets kept open per host and the requests a single host gets at once
+constexpr const int maxConnectionsPerHost = 4;
+// servers commonly close idle keep-alive connections after a minute or two
+constexpr const std::chrono::seconds idleTimeout{60};
+// how often a waiting caller checks whether its task was cancelled
+constexpr const unsigned long waitSliceMs = 250;
+}
+
+HttpClientPool &HttpClientPool::instance()
+{
+    static HttpClientPool pool;
+    return pool;
+}
+
+HttpClientPool::~HttpClientPool()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_idleChanged.wakeAll();
+    }
+    if (m_sweeper.joinable())
+    {
+        m_sweeper.join();
+    }
+}
+
+std::shared_ptr<HttpClient> HttpClientPool::acquire(const QUrl &url, const QString &proxyAddress)
+{
+    const bool https = url.scheme() == "https";
+    const int port = url.port(https ? 443 : 80);
+    const QString key = QString("%1://%2:%3|%4").arg(https ? "https" : "http").arg(url.host()).arg(port).arg(proxyAddress);
+
+    // closed outside the lock
+    std::vector<std::shared_ptr<HttpClient>> expired;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        for (;;)
+        {
+            expire(expired);
+
+            Host &entry = m_hosts[key];
+            if (!entry.idle.empty())
+            {
+                std::shared_ptr<HttpClient> client = std::move(entry.idle.back().client);
+                entry.idle.pop_back();
+                ++entry.leased;
+                locker.unlock();
+
+                client->reset(true);
+                return lease(key, std::move(client));
+            }
+            if (entry.leased < maxConnectionsPerHost)
+            {
+                ++entry.leased;
+                break;
+            }
+            if (FutureScheduler::cancelled())
+            {
+                return nullptr;
+            }
+            m_released.wait(&m_mutex, waitSliceMs);
+        }
+    }
+
+    // the connection itself is opened by the first request
+    auto client = std::make_shared<HttpClient>();
+    if (!client->set_proxy(proxyAddress.toStdString()))
+    {
+        qCritical() << "Failed to set proxy address" << proxyAddress;
+
+        QMutexLocker locker(&m_mutex);
+        --m_hosts[key].leased;
+        m_released.wakeAll();
+        return nullptr;
+    }
+    client->set_server(url.host().toStdString(), std::to_string(port), {});
+    return lease(key, std::move(client));
+}
+
+std::shared_ptr<HttpClient> HttpClientPool::lease(const QString &key, std::shared_ptr<HttpClient> client)
+{
+    HttpClient *leased = client.get();
+    return std::shared_ptr<HttpClient>(leased, [this, key, client](HttpClient *) {
+        release(key, client);
+    });
+}
+
+void HttpClientPool::release(const QString &key, std::shared_ptr<HttpClient> client)
+{
+    // a failed or closed connection is not kept, the next lease opens a fresh one
+    const bool reusable = !client->discarded() && client->is_connected();
+
+    QMutexLocker locker(&m_mutex);
+
+    Host &entry = m_hosts[key];
+    --entry.leased;
+    if (reusable)
+    {
+        entry.idle.push_back({std::move(client), std::chrono::steady_clock::now()});
+        if (!m_sweeper.joinable())
+        {
+            m_sweeper = std::thread([this] {
+                sweep();
+            });
+        }
+        m_idleChanged.wakeAll();
+    }
+    m_released.wakeAll();
+}
+
+void HttpClientPool::sweep()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopping)
+    {
+        std::vector<std::shared_ptr<HttpClient>> expired;
+        expire(expired);
+        if (!expired.empty())
+        {
+            // closed outside the lock
+            locker.unlock();
+            expired.clear();
+            locker.relock();
+            continue;
+        }
+
+        auto next = std::chrono::steady_clock::time_point::max();
+        for (const Host &host : m_hosts)
+        {
+            for (const Idle &idle : host.idle)
+            {
+                next = std::min(next, idle.since + idleTimeout);
+            }
+        }
+        if (next == std::chrono::steady_clock::time_point::max())
+        {
+            m_idleChanged.wait(&m_mutex);
+            continue;
+        }
+
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(next - std::chrono::steady_clock::now());
+        m_idleChanged.wait(&m_mutex, static_cast<unsigned long>(std::max<qint64>(remaining.count(), 0)) + 1);
+    }
+}
+
+void HttpClientPool::expire(std::vector<std::shared_ptr<HttpClient>> &expired)
+{
+    const auto now = std::chrono::steady_clock::now();
+    for (auto host = m_hosts.begin(); host != m_hosts.end();)
+    {
+        std::vector<Idle> &idle = host->idle;
+        for (auto it = idle.begin(); it != idle.end();)
+        {
+            if (now - it->since >= idleTimeout)
+            {
+                expired.push_back(std::move(it->client));
+                it = idle.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if (idle.empty() && host->leased == 0)
+        {
+            host = m_hosts.erase(host);
+        }
+        else
+        {
+            ++host;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QUrl>
+#include <QWaitCondition>
+
+#include "network.h"
+
+// Process-wide pool of keep-alive HTTP clients. A client stays bound to the scheme, host, port and
+// proxy it was created for, so a reused one skips the TCP, TLS and SOCKS handshakes. Leases are
+// plain shared pointers that hand the client back to the pool once the last copy is dropped.
+// Connections left idle for too long are closed by a sweeper thread, even if no request follows.
+class HttpClientPool
+{
+public:
+    static HttpClientPool &instance();
+
+    // Waits while the host is at its connection limit, returns nullptr if the client can't be set
+    // up or the calling task was cancelled meanwhile.
+    std::shared_ptr<HttpClient> acquire(const QUrl &url, const QString &proxyAddress);
+
+private:
+    struct Idle
+    {
+        std::shared_ptr<HttpClient> client;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    struct Host
+    {
+        std::vector<Idle> idle;
+        int leased = 0;
+    };
+
+    HttpClientPool() = default;
+    ~HttpClientPool();
+
+    std::shared_ptr<HttpClient> lease(const QString &key, std::shared_ptr<HttpClient> client);
+    void release(const QString &key, std::shared_ptr<HttpClient> client);
+    // drops connections idle for too long, m_mutex must be held
+    void expire(std::vector<std::shared_ptr<HttpClient>> &expired);
+    // sweeper thread, expires idle connections on schedule until the pool is destroyed
+    void sweep();
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_released;
+    QHash<QString, Host> m_hosts;
+    // started with the first idle connection
+    std::thread m_sweeper;
+    QWaitCondition m_idleChanged;
+    bool m_stopping = false;
+};
@@ -0,0 +1,500 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "PriceFeed.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrl>
+
+#include "HttpClientPool.h"
+#include "utils.h"
+
+using epee::net_utils::http::fields_list;
+using epee::net_utils::http::http_response_info;
+
+namespace
+{
+constexpr const std::chrono::seconds refreshInterval{60};
+constexpr const std::chrono::seconds requestTimeout{15};
+// quotes older than this are left out of the median, the price is reported stale past it
+constexpr const qint64 maxQuoteAgeSecs = 5 * 60;
+constexpr const char medianProvider[] = "median";
+
+struct Source
+{
+    const char *name;
+    QString (*url)(const QString &fiat);
+    double (*parse)(const QJsonObject &response, const QString &fiat);
+};
+
+const Source priceSources[] = {
+    {
+        "kraken",
+        [](const QString &fiat) {
+            return QString("https://api.kraken.com/0/public/Ticker?pair=XMR%1").arg(fiat.toUpper());
+        },
+        [](const QJsonObject &response, const QString &fiat) {
+            if (!response.value("error").toArray().isEmpty())
+            {
+                return 0.0;
+            }
+            const QJsonObject ticker = response.value("result").toObject().value("XXMRZ" + fiat.toUpper()).toObject();
+            return ticker.value("c").toArray().at(0).toString().toDouble();
+        },
+    },
+    {
+        "coingecko",
+        [](const QString &fiat) {
+            return QString("https://api.coingecko.com/api/v3/simple/price?ids=monero&vs_currencies=%1").arg(fiat);
+        },
+        [](const QJsonObject &response, const QString &fiat) {
+            return response.value("monero").toObject().value(fiat).toDouble();
+        },
+    },
+    {
+        "cryptocompare",
+        [](const QString &fiat) {
+            return QString("https://min-api.cryptocompare.com/data/price?fsym=XMR&tsyms=%1").arg(fiat.toUpper());
+        },
+        [](const QJsonObject &response, const QString &fiat) {
+            return response.value(fiat.toUpper()).toDouble();
+        },
+    },
+};
+
+const Source *findSource(const QString &name)
+{
+    for (const Source &source : priceSources)
+    {
+        if (name == source.name)
+        {
+            return &source;
+        }
+    }
+    return nullptr;
+}
+
+// "xmrusd" -> "usd"
+QString fiatOf(const QString &currency)
+{
+    return currency.mid(3);
+}
+
+std::string headerValue(const http_response_info &response, const char *name)
+{
+    for (const auto &field : response.m_header_info.m_etc_fields)
+    {
+        if (QString::fromStdString(field.first).compare(name, Qt::CaseInsensitive) == 0)
+        {
+            return field.second;
+        }
+    }
+    return {};
+}
+}
+
+PriceFeed::PriceFeed(QObject *parent)
+    : QObject(parent)
+    , m_currency("xmrusd")
+    , m_provider("kraken")
+    , m_active(false)
+    , m_price(0)
+    , m_pending(0)
+    , m_refreshQueued(false)
+    , m_scheduler(this)
+{
+    m_timer.setInterval(std::chrono::duration_cast<std::chrono::milliseconds>(refreshInterval).count());
+    connect(&m_timer, &QTimer::timeout, this, &PriceFeed::refresh);
+    connect(this, &PriceFeed::fetched, this, &PriceFeed::onFetched, Qt::QueuedConnection);
+}
+
+PriceFeed::~PriceFeed()
+{
+    m_scheduler.shutdownWaitForFinished();
+}
+
+QStringList PriceFeed::providers() const
+{
+    QStringList result({medianProvider});
+    for (const Source &source : priceSources)
+    {
+        result.append(source.name);
+    }
+    return result;
+}
+
+QStringList PriceFeed::currencies() const
+{
+    return {"xmrusd", "xmreur"};
+}
+
+void PriceFeed::refresh()
+{
+    if (m_pending > 0)
+    {
+        m_refreshQueued = true;
+        return;
+    }
+    m_refreshQueued = false;
+
+    if (!currencies().contains(m_currency))
+    {
+        setError(QString("currency \"%1\" not implemented").arg(m_currency));
+        return;
+    }
+    if (m_provider != medianProvider && findSource(m_provider) == nullptr)
+    {
+        setError(QString("provider \"%1\" not implemented").arg(m_provider));
+        return;
+    }
+
+    for (const Source &source : priceSources)
+    {
+        if (m_provider != medianProvider && m_provider != source.name)
+        {
+            continue;
+        }
+
+        const QString provider = source.name;
+        const QString url = source.url(fiatOf(m_currency));
+        const QString currency = m_currency;
+        const QString proxyAddress = m_proxyAddress;
+        const Quote cached = m_quotes.value(url);
+        const auto future = m_scheduler.run([this, provider, url, currency, cached, proxyAddress] {
+            const Result result = fetch(provider, url, currency, cached, proxyAddress);
+            {
+                QMutexLocker locker(&m_resultsMutex);
+                m_results.append(result);
+            }
+            emit fetched();
+        }, FutureScheduler::Lane::Dedicated, FutureScheduler::Priority_Low, "price");
+        if (future.first)
+        {
+            ++m_pending;
+        }
+    }
+}
+
+PriceFeed::Result PriceFeed::fetch(const QString &provider, const QString &url, const QString &currency, const Quote &cached, const QString &proxyAddress)
+{
+    Result result;
+    result.provider = provider;
+    result.url = url;
+
+    std::shared_ptr<HttpClient> client = HttpClientPool::instance().acquire(QUrl(url), proxyAddress);
+    if (!client)
+    {
+        result.error = "failed to initialize a client";
+        return result;
+    }
+
+    const QUrl urlParsed(url);
+    const std::string uri = (urlParsed.path() + "?" + urlParsed.query()).toStdString();
+    fields_list headers({{"User-Agent", randomUserAgent().toStdString()}, {"Accept", "application/json"}});
+    // only worth revalidating what can be served again on 304 Not Modified
+    if (cached.price > 0)
+    {
+        if (!cached.etag.empty())
+        {
+            headers.push_back({"If-None-Match", cached.etag});
+        }
+        if (!cached.lastModified.empty())
+        {
+            headers.push_back({"If-Modified-Since", cached.lastModified});
+        }
+    }
+
+    const http_response_info *response = nullptr;
+    const bool invoked = client->request(uri, "GET", {}, requestTimeout, std::addressof(response), headers);
+    if (!invoked || response == nullptr)
+    {
+        result.error = "no response";
+        return result;
+    }
+
+    if (response->m_response_code == 304 && cached.price > 0)
+    {
+        result.ok = true;
+        result.quote = cached;
+        result.quote.fetchedAt = QDateTime::currentDateTimeUtc();
+        return result;
+    }
+    if (response->m_response_code != 200)
+    {
+        result.error = QString("response code %1").arg(response->m_response_code);
+        return result;
+    }
+
+    const QJsonDocument document = QJsonDocument::fromJson(QByteArray::fromStdString(response->m_body));
+    if (!document.isObject())
+    {
+        result.error = "bad JSON";
+        return result;
+    }
+    const double price = findSource(provider)->parse(document.object(), fiatOf(currency));
+    if (!(price > 0))
+    {
+        result.error = "could not get ticker";
+        return result;
+    }
+
+    result.ok = true;
+    result.quote.price = price;
+    result.quote.fetchedAt = QDateTime::currentDateTimeUtc();
+    result.quote.etag = headerValue(*response, "ETag");
+    result.quote.lastModified = headerValue(*response, "Last-Modified");
+    return result;
+}
+
+void PriceFeed::onFetched()
+{
+    QVector<Result> results;
+    {
+        QMutexLocker locker(&m_resultsMutex);
+        results.swap(m_results);
+    }
+
+    for (const Result &result : results)
+    {
+        --m_pending;
+        if (result.ok)
+        {
+            m_quotes[result.url] = result.quote;
+        }
+        else
+        {
+            m_roundErrors.append(QString("%1: %2").arg(result.provider, result.error));
+        }
+    }
+
+    if (m_pending > 0)
+    {
+        return;
+    }
+
+    for (const QString &error : m_roundErrors)
+    {
+        qDebug() << "Failed to fetch price from" << error;
+    }
+    // a failing source is only an error while no other one provides a price
+    const bool priced = updatePrice();
+    setError(priced ? QString() : m_roundErrors.join("; "));
+    m_roundErrors.clear();
+
+    if (m_refreshQueued)
+    {
+        refresh();
+    }
+}
+
+PriceFeed::Aggregate PriceFeed::aggregate(const QVector<SourcePrice> &quotes, const QDateTime &now)
+{
+    Aggregate result;
+    QVector<double> prices;
+    for (const SourcePrice &quote : quotes)
+    {
+        if (quote.price <= 0 || !quote.fetchedAt.isValid() || quote.fetchedAt.secsTo(now) > maxQuoteAgeSecs)
+        {
+            continue;
+        }
+        prices.append(quote.price);
+        result.sources.append(quote.source);
+        // the price is only as fresh as the oldest quote it's made of
+        if (!result.updatedAt.isValid() || quote.fetchedAt < result.updatedAt)
+        {
+            result.updatedAt = quote.fetchedAt;
+        }
+    }
+
+    if (prices.isEmpty())
+    {
+        return result;
+    }
+
+    std::sort(prices.begin(), prices.end());
+    const int middle = prices.size() / 2;
+    result.price = prices.size() % 2 ? prices[middle] : (prices[middle - 1] + prices[middle]) / 2;
+    return result;
+}
+
+bool PriceFeed::updatePrice()
+{
+    QVector<SourcePrice> quotes;
+    for (const Source &source : priceSources)
+    {
+        if (m_provider != medianProvider && m_provider != source.name)
+        {
+            continue;
+        }
+
+        const Quote quote = m_quotes.value(source.url(fiatOf(m_currency)));
+        quotes.append({source.name, quote.price, quote.fetchedAt});
+    }
+
+    // nothing recent enough, the last price is kept and goes stale
+    const Aggregate aggregated = aggregate(quotes, QDateTime::currentDateTimeUtc());
+    if (aggregated.price <= 0)
+    {
+        emit priceChanged();
+        return false;
+    }
+
+    m_price = aggregated.price;
+    m_updatedAt = aggregated.updatedAt;
+    m_sources = aggregated.sources;
+    emit priceChanged();
+    return true;
+}
+
+void PriceFeed::setError(const QString &error)
+{
+    if (m_error == error)
+    {
+        return;
+    }
+    m_error = error;
+    emit errorChanged();
+}
+
+QString PriceFeed::proxyAddress() const
+{
+    return m_proxyAddress;
+}
+
+void PriceFeed::setProxyAddress(const QString &address)
+{
+    if (m_proxyAddress == address)
+    {
+        return;
+    }
+    m_proxyAddress = address;
+    emit proxyAddressChanged();
+}
+
+QString PriceFeed::currency() const
+{
+    return m_currency;
+}
+
+void PriceFeed::setCurrency(const QString &currency)
+{
+    if (m_currency == currency)
+    {
+        return;
+    }
+    m_currency = currency;
+    emit currencyChanged();
+
+    m_price = 0;
+    m_updatedAt = QDateTime();
+    m_sources.clear();
+    updatePrice();
+    if (m_active)
+    {
+        refresh();
+    }
+}
+
+QString PriceFeed::provider() const
+{
+    return m_provider;
+}
+
+void PriceFeed::setProvider(const QString &provider)
+{
+    if (m_provider == provider)
+    {
+        return;
+    }
+    m_provider = provider;
+    emit providerChanged();
+
+    m_price = 0;
+    m_updatedAt = QDateTime();
+    m_sources.clear();
+    updatePrice();
+    if (m_active)
+    {
+        refresh();
+    }
+}
+
+bool PriceFeed::active() const
+{
+    return m_active;
+}
+
+void PriceFeed::setActive(bool active)
+{
+    if (m_active == active)
+    {
+        return;
+    }
+    m_active = active;
+    if (m_active)
+    {
+        m_timer.start();
+        refresh();
+    }
+    else
+    {
+        m_timer.stop();
+    }
+    emit activeChanged();
+}
+
+double PriceFeed::price() const
+{
+    return m_price;
+}
+
+QDateTime PriceFeed::updatedAt() const
+{
+    return m_updatedAt;
+}
+
+bool PriceFeed::stale() const
+{
+    return !m_updatedAt.isValid() || m_updatedAt.secsTo(QDateTime::currentDateTimeUtc()) > maxQuoteAgeSecs;
+}
+
+QStringList PriceFeed::sources() const
+{
+    return m_sources;
+}
+
+QString PriceFeed::error() const
+{
+    return m_error;
+}
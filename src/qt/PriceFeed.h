@@ -0,0 +1,163 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef PRICE_FEED_H
+#define PRICE_FEED_H
+
+#include <string>
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+#include "FutureScheduler.h"
+
+// XMR fiat price, fetched from the selected price source or, with the "median" provider, from
+// every source concurrently and aggregated as the median of the recent quotes so that a single
+// failing or misreporting source can't skew it. Sources are polled with conditional requests,
+// the last good price is kept along with its age.
+class PriceFeed : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString proxyAddress READ proxyAddress WRITE setProxyAddress NOTIFY proxyAddressChanged)
+    Q_PROPERTY(QString currency READ currency WRITE setCurrency NOTIFY currencyChanged)
+    Q_PROPERTY(QString provider READ provider WRITE setProvider NOTIFY providerChanged)
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(double price READ price NOTIFY priceChanged)
+    Q_PROPERTY(QDateTime updatedAt READ updatedAt NOTIFY priceChanged)
+    Q_PROPERTY(bool stale READ stale NOTIFY priceChanged)
+    Q_PROPERTY(QStringList sources READ sources NOTIFY priceChanged)
+    Q_PROPERTY(QString error READ error NOTIFY errorChanged)
+
+public:
+    struct SourcePrice
+    {
+        QString source;
+        double price = 0;
+        QDateTime fetchedAt;
+    };
+
+    struct Aggregate
+    {
+        // 0 when no quote was recent enough
+        double price = 0;
+        // fetch time of the oldest quote used
+        QDateTime updatedAt;
+        QStringList sources;
+    };
+
+    PriceFeed(QObject *parent = nullptr);
+    ~PriceFeed();
+
+    // Median of the quotes fetched at most 5 minutes before now, only depends on its arguments.
+    static Aggregate aggregate(const QVector<SourcePrice> &quotes, const QDateTime &now);
+
+    // Price source names, "median" aggregates all of them.
+    Q_INVOKABLE QStringList providers() const;
+    Q_INVOKABLE QStringList currencies() const;
+    // Starts a fetch round, or queues one if a round is still running.
+    Q_INVOKABLE void refresh();
+
+    QString proxyAddress() const;
+    void setProxyAddress(const QString &address);
+    QString currency() const;
+    void setCurrency(const QString &currency);
+    QString provider() const;
+    void setProvider(const QString &provider);
+    bool active() const;
+    void setActive(bool active);
+    // 0 until a price for the current currency was fetched.
+    double price() const;
+    QDateTime updatedAt() const;
+    bool stale() const;
+    // Sources the current price was aggregated from.
+    QStringList sources() const;
+    QString error() const;
+
+signals:
+    void proxyAddressChanged() const;
+    void currencyChanged() const;
+    void providerChanged() const;
+    void activeChanged() const;
+    void priceChanged() const;
+    void errorChanged() const;
+    // Emitted by the fetch workers, results are merged on the owner's thread.
+    void fetched() const;
+
+private slots:
+    void onFetched();
+
+private:
+    // last answer of a source for one url, with the validators for the next conditional request
+    struct Quote
+    {
+        double price = 0;
+        QDateTime fetchedAt;
+        std::string etag;
+        std::string lastModified;
+    };
+
+    struct Result
+    {
+        QString provider;
+        QString url;
+        bool ok = false;
+        Quote quote;
+        QString error;
+    };
+
+    static Result fetch(const QString &provider, const QString &url, const QString &currency, const Quote &cached, const QString &proxyAddress);
+    // Whether a price could be computed from recent quotes.
+    bool updatePrice();
+    void setError(const QString &error);
+
+private:
+    QString m_proxyAddress;
+    QString m_currency;
+    QString m_provider;
+    bool m_active;
+    double m_price;
+    QDateTime m_updatedAt;
+    QStringList m_sources;
+    QString m_error;
+    QHash<QString, Quote> m_quotes;
+    int m_pending;
+    bool m_refreshQueued;
+    QStringList m_roundErrors;
+    QTimer m_timer;
+    QMutex m_resultsMutex;
+    QVector<Result> m_results;
+    mutable FutureScheduler m_scheduler;
+};
+
+#endif // PRICE_FEED_H
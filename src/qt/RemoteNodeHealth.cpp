@@ -0,0 +1,480 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "RemoteNodeHealth.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "network.h"
+
+namespace
+{
+constexpr const std::chrono::seconds probeInterval{30};
+// remote nodes are often reached over tor, a slow answer is still an answer
+constexpr const std::chrono::seconds probeTimeout{10};
+constexpr const size_t sampleWindow = 10;
+constexpr const int failoverFailures = 3;
+constexpr const quint64 failoverLag = 10;
+// a block behind costs as much as a second of latency
+constexpr const double lagPenaltyMs = 1000;
+
+QString networkName(NetworkType::Type nettype)
+{
+    switch (nettype)
+    {
+    case NetworkType::TESTNET:
+        return "testnet";
+    case NetworkType::STAGENET:
+        return "stagenet";
+    default:
+        return "mainnet";
+    }
+}
+}
+
+RemoteNodeHealth::RemoteNodeHealth(QObject *parent)
+    : QObject(parent)
+    , m_nettype(NetworkType::MAINNET)
+    , m_active(false)
+    , m_failoverEnabled(false)
+    , m_current(-1)
+    , m_pending(0)
+    , m_scheduler(this)
+{
+    m_timer.setInterval(std::chrono::duration_cast<std::chrono::milliseconds>(probeInterval).count());
+    connect(&m_timer, &QTimer::timeout, this, &RemoteNodeHealth::probe);
+    connect(this, &RemoteNodeHealth::probed, this, &RemoteNodeHealth::onProbed, Qt::QueuedConnection);
+}
+
+RemoteNodeHealth::~RemoteNodeHealth()
+{
+    m_scheduler.shutdownWaitForFinished();
+}
+
+void RemoteNodeHealth::setNodes(const QVariantList &nodes)
+{
+    m_nodes.clear();
+    QMap<QString, Stats> stats;
+    for (const QVariant &value : nodes)
+    {
+        const QVariantMap node = value.toMap();
+        const QString address = node.value("address").toString();
+        m_nodes.append({address, node.value("username").toString(), node.value("password").toString()});
+        stats.insert(address, m_stats.value(address));
+    }
+    m_stats = std::move(stats);
+    emit scoresChanged();
+
+    if (m_active)
+    {
+        probe();
+    }
+}
+
+void RemoteNodeHealth::probe()
+{
+    if (m_pending > 0)
+    {
+        return;
+    }
+
+    // nodes the user didn't select are only contacted when they may have to replace the selected one
+    const bool candidates = m_failoverEnabled && currentFailing();
+    for (int index = 0; index < m_nodes.size(); ++index)
+    {
+        const Node &node = m_nodes[index];
+        if (index != m_current && !candidates)
+        {
+            // stats of an earlier candidate round would only go stale
+            m_stats[node.address] = Stats();
+            continue;
+        }
+
+        const QString proxyAddress = m_proxyAddress;
+        const NetworkType::Type nettype = m_nettype;
+        const auto future = m_scheduler.run([this, node, proxyAddress, nettype] {
+            const Result result = probeNode(node, proxyAddress, nettype);
+            {
+                QMutexLocker locker(&m_resultsMutex);
+                m_results.append(result);
+            }
+            emit probed();
+        }, FutureScheduler::Lane::Dedicated, FutureScheduler::Priority_Low, "probe");
+        if (future.first)
+        {
+            ++m_pending;
+        }
+    }
+}
+
+bool RemoteNodeHealth::currentFailing() const
+{
+    return m_current >= 0 && m_current < m_nodes.size() && m_stats.value(m_nodes[m_current].address).consecutiveFailures > 0;
+}
+
+RemoteNodeHealth::Result RemoteNodeHealth::probeNode(const Node &node, const QString &proxyAddress, NetworkType::Type nettype)
+{
+    Result result;
+    result.address = node.address;
+
+    const int separator = node.address.lastIndexOf(':');
+    if (separator <= 0)
+    {
+        result.error = "invalid address";
+        return result;
+    }
+    QString host = node.address.left(separator);
+    if (host.startsWith('[') && host.endsWith(']'))
+    {
+        host = host.mid(1, host.size() - 2);
+    }
+    const QString port = node.address.mid(separator + 1);
+
+    net::http::client client;
+    // same as the wallet, a node on this machine is never reached through the proxy
+    const bool local = host == "127.0.0.1" || host == "localhost";
+    if (!client.set_proxy(local ? std::string() : proxyAddress.toStdString()))
+    {
+        result.error = "failed to set proxy address";
+        return result;
+    }
+    boost::optional<epee::net_utils::http::login> login;
+    if (!node.username.isEmpty())
+    {
+        login.emplace(node.username.toStdString(), node.password.toStdString());
+    }
+    client.set_server(host.toStdString(), port.toStdString(), login);
+
+    const std::string body = R"({"jsonrpc":"2.0","id":"0","method":"get_info"})";
+    const epee::net_utils::http::http_response_info *response = nullptr;
+    QElapsedTimer timer;
+    timer.start();
+    const bool invoked = client.invoke("/json_rpc", "POST", body, probeTimeout, std::addressof(response),
+                                       {{"Content-Type", "application/json; charset=utf-8"}});
+    result.latencyMs = timer.elapsed();
+
+    if (!invoked || response == nullptr)
+    {
+        result.error = "no response";
+        return result;
+    }
+    if (response->m_response_code != 200)
+    {
+        result.error = QString("response code %1").arg(response->m_response_code);
+        return result;
+    }
+
+    const QJsonObject info = QJsonDocument::fromJson(QByteArray::fromStdString(response->m_body)).object().value("result").toObject();
+    if (info.value("status").toString() != "OK")
+    {
+        result.error = info.isEmpty() ? "malformed response" : info.value("status").toString();
+        return result;
+    }
+    // older daemons don't report the network type
+    if (info.contains("nettype") && info.value("nettype").toString() != networkName(nettype))
+    {
+        result.error = QString("wrong network %1").arg(info.value("nettype").toString());
+        return result;
+    }
+
+    result.ok = true;
+    result.height = static_cast<quint64>(info.value("height").toDouble());
+    result.version = info.value("version").toString();
+    return result;
+}
+
+void RemoteNodeHealth::onProbed()
+{
+    QVector<Result> results;
+    {
+        QMutexLocker locker(&m_resultsMutex);
+        results.swap(m_results);
+    }
+
+    for (const Result &result : results)
+    {
+        --m_pending;
+        // the node may have been removed while it was probed
+        if (!m_stats.contains(result.address))
+        {
+            continue;
+        }
+
+        Stats &stats = m_stats[result.address];
+        stats.samples.push_back(result);
+        if (stats.samples.size() > sampleWindow)
+        {
+            stats.samples.pop_front();
+        }
+        stats.error = result.error;
+        if (result.ok)
+        {
+            stats.consecutiveFailures = 0;
+            stats.height = result.height;
+            stats.version = result.version;
+        }
+        else
+        {
+            ++stats.consecutiveFailures;
+        }
+    }
+    emit scoresChanged();
+
+    if (m_pending == 0)
+    {
+        evaluate();
+    }
+}
+
+void RemoteNodeHealth::evaluate()
+{
+    if (!m_failoverEnabled || m_current < 0 || m_current >= m_nodes.size())
+    {
+        return;
+    }
+
+    const Stats stats = m_stats.value(m_nodes[m_current].address);
+    QString reason;
+    if (stats.consecutiveFailures >= failoverFailures)
+    {
+        reason = QString("not responding (%1)").arg(stats.error);
+    }
+    else if (online(stats) && heightLag(stats) >= failoverLag)
+    {
+        reason = QString("%1 blocks behind").arg(heightLag(stats));
+    }
+    if (reason.isEmpty())
+    {
+        return;
+    }
+
+    const int candidate = best();
+    if (candidate < 0 || candidate == m_current)
+    {
+        return;
+    }
+    qWarning() << "Remote node" << m_nodes[m_current].address << reason << "- switching to" << m_nodes[candidate].address;
+    emit failover(candidate, reason);
+}
+
+bool RemoteNodeHealth::online(const Stats &stats) const
+{
+    return !stats.samples.empty() && stats.samples.back().ok;
+}
+
+quint64 RemoteNodeHealth::referenceHeight() const
+{
+    // the upper median, so that a single node claiming a far away height can't make every other one look stale
+    QVector<quint64> heights;
+    for (const Stats &stats : m_stats)
+    {
+        if (online(stats))
+        {
+            heights.append(stats.height);
+        }
+    }
+    if (heights.isEmpty())
+    {
+        return 0;
+    }
+    std::sort(heights.begin(), heights.end());
+    return heights[heights.size() / 2];
+}
+
+quint64 RemoteNodeHealth::heightLag(const Stats &stats) const
+{
+    const quint64 reference = referenceHeight();
+    return reference > stats.height ? reference - stats.height : 0;
+}
+
+double RemoteNodeHealth::score(const Stats &stats) const
+{
+    if (!online(stats))
+    {
+        return -1;
+    }
+
+    qint64 latency = 0;
+    int answered = 0;
+    for (const Result &sample : stats.samples)
+    {
+        if (sample.ok)
+        {
+            latency += sample.latencyMs;
+            ++answered;
+        }
+    }
+    const double successRate = static_cast<double>(answered) / stats.samples.size();
+    return static_cast<double>(latency) / answered / successRate + heightLag(stats) * lagPenaltyMs;
+}
+
+QVariantList RemoteNodeHealth::scores() const
+{
+    QVariantList result;
+    for (const Node &node : m_nodes)
+    {
+        const Stats stats = m_stats.value(node.address);
+
+        qint64 latency = 0;
+        int answered = 0;
+        for (const Result &sample : stats.samples)
+        {
+            if (sample.ok)
+            {
+                latency += sample.latencyMs;
+                ++answered;
+            }
+        }
+
+        QVariantMap entry;
+        entry["address"] = node.address;
+        entry["probed"] = !stats.samples.empty();
+        entry["online"] = online(stats);
+        entry["latency"] = answered > 0 ? latency / answered : -1;
+        entry["successRate"] = stats.samples.empty() ? 0.0 : static_cast<double>(answered) / stats.samples.size();
+        entry["height"] = stats.height;
+        entry["heightLag"] = online(stats) ? heightLag(stats) : 0;
+        entry["version"] = stats.version;
+        entry["error"] = stats.error;
+        entry["score"] = score(stats);
+        result.append(entry);
+    }
+    return result;
+}
+
+int RemoteNodeHealth::best() const
+{
+    int bestIndex = -1;
+    double bestScore = 0;
+    for (int index = 0; index < m_nodes.size(); ++index)
+    {
+        const double nodeScore = score(m_stats.value(m_nodes[index].address));
+        if (nodeScore >= 0 && (bestIndex < 0 || nodeScore < bestScore))
+        {
+            bestIndex = index;
+            bestScore = nodeScore;
+        }
+    }
+    return bestIndex;
+}
+
+QString RemoteNodeHealth::proxyAddress() const
+{
+    return m_proxyAddress;
+}
+
+void RemoteNodeHealth::setProxyAddress(const QString &address)
+{
+    if (m_proxyAddress == address)
+    {
+        return;
+    }
+    m_proxyAddress = address;
+    emit proxyAddressChanged();
+}
+
+NetworkType::Type RemoteNodeHealth::nettype() const
+{
+    return m_nettype;
+}
+
+void RemoteNodeHealth::setNettype(NetworkType::Type nettype)
+{
+    if (m_nettype == nettype)
+    {
+        return;
+    }
+    m_nettype = nettype;
+    // stats gathered on another network say nothing about this one
+    for (Stats &stats : m_stats)
+    {
+        stats = Stats();
+    }
+    emit nettypeChanged();
+    emit scoresChanged();
+}
+
+bool RemoteNodeHealth::active() const
+{
+    return m_active;
+}
+
+void RemoteNodeHealth::setActive(bool active)
+{
+    if (m_active == active)
+    {
+        return;
+    }
+    m_active = active;
+    if (m_active)
+    {
+        m_timer.start();
+        probe();
+    }
+    else
+    {
+        m_timer.stop();
+    }
+    emit activeChanged();
+}
+
+bool RemoteNodeHealth::failoverEnabled() const
+{
+    return m_failoverEnabled;
+}
+
+void RemoteNodeHealth::setFailoverEnabled(bool enabled)
+{
+    if (m_failoverEnabled == enabled)
+    {
+        return;
+    }
+    m_failoverEnabled = enabled;
+    emit failoverEnabledChanged();
+}
+
+int RemoteNodeHealth::current() const
+{
+    return m_current;
+}
+
+void RemoteNodeHealth::setCurrent(int index)
+{
+    if (m_current == index)
+    {
+        return;
+    }
+    m_current = index;
+    emit currentChanged();
+}
@@ -0,0 +1,152 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef REMOTE_NODE_HEALTH_H
+#define REMOTE_NODE_HEALTH_H
+
+#include <deque>
+
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVariantList>
+#include <QVector>
+
+#include "FutureScheduler.h"
+#include "NetworkType.h"
+
+// Probes the selected remote node with a get_info request and keeps rolling latency, availability
+// and height stats per address. Failover is opt-in: only then, and only once the selected node
+// fails a probe, are the other configured nodes probed concurrently. The node in use is failed
+// over to the best scoring candidate once it stops answering or falls behind the others.
+class RemoteNodeHealth : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString proxyAddress READ proxyAddress WRITE setProxyAddress NOTIFY proxyAddressChanged)
+    Q_PROPERTY(NetworkType::Type nettype READ nettype WRITE setNettype NOTIFY nettypeChanged)
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(bool failoverEnabled READ failoverEnabled WRITE setFailoverEnabled NOTIFY failoverEnabledChanged)
+    Q_PROPERTY(int current READ current WRITE setCurrent NOTIFY currentChanged)
+    Q_PROPERTY(QVariantList scores READ scores NOTIFY scoresChanged)
+    Q_PROPERTY(int best READ best NOTIFY scoresChanged)
+
+public:
+    RemoteNodeHealth(QObject *parent = nullptr);
+    ~RemoteNodeHealth();
+
+    // Each node is a map with address, username and password, as stored by the remote node list.
+    Q_INVOKABLE void setNodes(const QVariantList &nodes);
+    // Starts a probe round unless one is still running.
+    Q_INVOKABLE void probe();
+
+    QString proxyAddress() const;
+    void setProxyAddress(const QString &address);
+    NetworkType::Type nettype() const;
+    void setNettype(NetworkType::Type nettype);
+    bool active() const;
+    void setActive(bool active);
+    bool failoverEnabled() const;
+    void setFailoverEnabled(bool enabled);
+    int current() const;
+    void setCurrent(int index);
+    // One map per node, in the order given to setNodes.
+    QVariantList scores() const;
+    // Index of the best scoring reachable node, -1 if none answered.
+    int best() const;
+
+signals:
+    void proxyAddressChanged() const;
+    void nettypeChanged() const;
+    void activeChanged() const;
+    void failoverEnabledChanged() const;
+    void currentChanged() const;
+    void scoresChanged() const;
+    // The current node should be replaced by the node at index.
+    void failover(int index, const QString &reason) const;
+    // Emitted by the probe workers, results are merged on the owner's thread.
+    void probed() const;
+
+private slots:
+    void onProbed();
+
+private:
+    struct Node
+    {
+        QString address;
+        QString username;
+        QString password;
+    };
+
+    struct Result
+    {
+        QString address;
+        bool ok = false;
+        qint64 latencyMs = 0;
+        quint64 height = 0;
+        QString version;
+        QString error;
+    };
+
+    struct Stats
+    {
+        // the latest probes, oldest first
+        std::deque<Result> samples;
+        int consecutiveFailures = 0;
+        quint64 height = 0;
+        QString version;
+        QString error;
+    };
+
+    static Result probeNode(const Node &node, const QString &proxyAddress, NetworkType::Type nettype);
+    // the selected node's last probe failed
+    bool currentFailing() const;
+    void evaluate();
+    bool online(const Stats &stats) const;
+    quint64 referenceHeight() const;
+    quint64 heightLag(const Stats &stats) const;
+    // lower is better, negative for nodes that are not reachable
+    double score(const Stats &stats) const;
+
+private:
+    QVector<Node> m_nodes;
+    QMap<QString, Stats> m_stats;
+    QString m_proxyAddress;
+    NetworkType::Type m_nettype;
+    bool m_active;
+    bool m_failoverEnabled;
+    int m_current;
+    int m_pending;
+    QTimer m_timer;
+    QMutex m_resultsMutex;
+    QVector<Result> m_results;
+    mutable FutureScheduler m_scheduler;
+};
+
+#endif // REMOTE_NODE_HEALTH_H
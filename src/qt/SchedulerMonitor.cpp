@@ -0,0 +1,142 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SchedulerMonitor.h"
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QVariantMap>
+
+#include "FutureScheduler.h"
+#include "SchedulerTelemetry.h"
+
+SchedulerMonitor::SchedulerMonitor(QObject *parent)
+    : QObject(parent)
+{
+    connect(&m_refreshTimer, &QTimer::timeout, this, &SchedulerMonitor::updated);
+    m_refreshTimer.start(1000);
+
+    connect(&m_logTimer, &QTimer::timeout, this, &SchedulerMonitor::log);
+    setLogIntervalSeconds(60);
+}
+
+QVariantList SchedulerMonitor::lanes() const
+{
+    const auto stats = SchedulerTelemetry::instance().lanes();
+
+    QVariantList result;
+    for (const auto lane : {FutureScheduler::Lane::Interactive, FutureScheduler::Lane::Background, FutureScheduler::Lane::Dedicated})
+    {
+        const QString name = FutureScheduler::laneName(lane);
+        const SchedulerTelemetry::LaneStats laneStats = stats.value(name);
+        result.append(QVariantMap{
+            {"name", name},
+            {"queued", laneStats.queued},
+            {"running", laneStats.running},
+            {"maxThreads", FutureScheduler::laneThreadCount(lane)},
+        });
+    }
+    return result;
+}
+
+QVariantList SchedulerMonitor::tasks() const
+{
+    const auto stats = SchedulerTelemetry::instance().tasks();
+
+    QList<QString> names = stats.keys();
+    std::sort(names.begin(), names.end(), [&stats](const QString &a, const QString &b) {
+        return stats[a].totalRunMs > stats[b].totalRunMs;
+    });
+
+    QVariantList result;
+    for (const QString &name : names)
+    {
+        const SchedulerTelemetry::TaskStats &task = stats[name];
+        const qint64 runs = std::max<qint64>(1, task.runs);
+        result.append(QVariantMap{
+            {"name", name},
+            {"runs", task.runs},
+            {"avgQueueMs", task.totalQueueMs / runs},
+            {"maxQueueMs", task.maxQueueMs},
+            {"avgRunMs", task.totalRunMs / runs},
+            {"maxRunMs", task.maxRunMs},
+            {"running", task.running},
+            {"maxRunning", task.maxRunning},
+        });
+    }
+    return result;
+}
+
+int SchedulerMonitor::slowTaskThresholdMs() const
+{
+    return SchedulerTelemetry::instance().slowTaskThresholdMs();
+}
+
+void SchedulerMonitor::setSlowTaskThresholdMs(int thresholdMs)
+{
+    if (slowTaskThresholdMs() != thresholdMs)
+    {
+        SchedulerTelemetry::instance().setSlowTaskThresholdMs(thresholdMs);
+        emit slowTaskThresholdMsChanged();
+    }
+}
+
+int SchedulerMonitor::logIntervalSeconds() const
+{
+    return m_logTimer.isActive() ? m_logTimer.interval() / 1000 : 0;
+}
+
+void SchedulerMonitor::setLogIntervalSeconds(int seconds)
+{
+    if (logIntervalSeconds() == seconds)
+    {
+        return;
+    }
+
+    if (seconds > 0)
+    {
+        m_logTimer.start(seconds * 1000);
+    }
+    else
+    {
+        m_logTimer.stop();
+    }
+    emit logIntervalSecondsChanged();
+}
+
+void SchedulerMonitor::reset()
+{
+    SchedulerTelemetry::instance().reset();
+    emit updated();
+}
+
+void SchedulerMonitor::log() const
+{
+    qInfo() << "Scheduler:" << SchedulerTelemetry::instance().summary();
+}
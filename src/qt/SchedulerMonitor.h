@@ -0,0 +1,74 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SCHEDULER_MONITOR_H
+#define SCHEDULER_MONITOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVariantList>
+
+// Debug view of SchedulerTelemetry for QML, periodically refreshed and optionally logged.
+class SchedulerMonitor : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QVariantList lanes READ lanes NOTIFY updated)
+    Q_PROPERTY(QVariantList tasks READ tasks NOTIFY updated)
+    Q_PROPERTY(int slowTaskThresholdMs READ slowTaskThresholdMs WRITE setSlowTaskThresholdMs NOTIFY slowTaskThresholdMsChanged)
+    Q_PROPERTY(int logIntervalSeconds READ logIntervalSeconds WRITE setLogIntervalSeconds NOTIFY logIntervalSecondsChanged)
+
+public:
+    explicit SchedulerMonitor(QObject *parent = nullptr);
+
+    // Each lane is {name, queued, running, maxThreads}.
+    QVariantList lanes() const;
+    // Each task is {name, runs, avgQueueMs, maxQueueMs, avgRunMs, maxRunMs, running, maxRunning},
+    // sorted by total run time.
+    QVariantList tasks() const;
+
+    int slowTaskThresholdMs() const;
+    void setSlowTaskThresholdMs(int thresholdMs);
+    int logIntervalSeconds() const;
+    void setLogIntervalSeconds(int seconds);
+
+    Q_INVOKABLE void reset();
+
+signals:
+    void updated() const;
+    void slowTaskThresholdMsChanged() const;
+    void logIntervalSecondsChanged() const;
+
+private:
+    void log() const;
+
+private:
+    QTimer m_refreshTimer;
+    QTimer m_logTimer;
+};
+
+#endif // SCHEDULER_MONITOR_H
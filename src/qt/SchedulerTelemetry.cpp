@@ -0,0 +1,173 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SchedulerTelemetry.h"
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QStringList>
+#include <QVector>
+
+SchedulerTelemetry &SchedulerTelemetry::instance()
+{
+    static SchedulerTelemetry telemetry;
+    return telemetry;
+}
+
+SchedulerTelemetry::SchedulerTelemetry()
+    : SlowTaskThresholdMs(5000)
+{
+}
+
+void SchedulerTelemetry::taskQueued(const QString &lane)
+{
+    QMutexLocker locker(&Mutex);
+
+    ++Lanes[lane].queued;
+}
+
+void SchedulerTelemetry::taskStarted(const QString &lane, const QString &name, qint64 queueMs)
+{
+    QMutexLocker locker(&Mutex);
+
+    LaneStats &laneStats = Lanes[lane];
+    --laneStats.queued;
+    ++laneStats.running;
+
+    TaskStats &task = Tasks[name];
+    task.totalQueueMs += queueMs;
+    task.maxQueueMs = std::max(task.maxQueueMs, queueMs);
+    ++task.running;
+    task.maxRunning = std::max(task.maxRunning, task.running);
+}
+
+void SchedulerTelemetry::taskFinished(const QString &lane, const QString &name, qint64 runMs)
+{
+    {
+        QMutexLocker locker(&Mutex);
+
+        --Lanes[lane].running;
+
+        TaskStats &task = Tasks[name];
+        ++task.runs;
+        task.totalRunMs += runMs;
+        task.maxRunMs = std::max(task.maxRunMs, runMs);
+        --task.running;
+    }
+
+    const int threshold = SlowTaskThresholdMs;
+    if (threshold > 0 && runMs > threshold)
+    {
+        qInfo() << "Slow async task" << name << "on" << lane << "lane took" << runMs << "ms";
+    }
+}
+
+QHash<QString, SchedulerTelemetry::TaskStats> SchedulerTelemetry::tasks() const
+{
+    QMutexLocker locker(&Mutex);
+
+    return Tasks;
+}
+
+QHash<QString, SchedulerTelemetry::LaneStats> SchedulerTelemetry::lanes() const
+{
+    QMutexLocker locker(&Mutex);
+
+    return Lanes;
+}
+
+void SchedulerTelemetry::reset()
+{
+    QMutexLocker locker(&Mutex);
+
+    // queued and running counters describe live tasks, only the history is dropped
+    for (auto it = Tasks.begin(); it != Tasks.end();)
+    {
+        if (it->running > 0)
+        {
+            const int running = it->running;
+            *it = TaskStats();
+            it->running = running;
+            it->maxRunning = running;
+            ++it;
+        }
+        else
+        {
+            it = Tasks.erase(it);
+        }
+    }
+}
+
+int SchedulerTelemetry::slowTaskThresholdMs() const
+{
+    return SlowTaskThresholdMs;
+}
+
+void SchedulerTelemetry::setSlowTaskThresholdMs(int thresholdMs)
+{
+    SlowTaskThresholdMs = std::max(0, thresholdMs);
+}
+
+QString SchedulerTelemetry::summary() const
+{
+    QMutexLocker locker(&Mutex);
+
+    QStringList lanes;
+    for (auto it = Lanes.constBegin(); it != Lanes.constEnd(); ++it)
+    {
+        lanes << QString("%1 %2 queued/%3 running").arg(it.key()).arg(it->queued).arg(it->running);
+    }
+    lanes.sort();
+
+    // the tasks that kept pool threads busy the longest
+    QVector<QPair<qint64, QString>> busiest;
+    for (auto it = Tasks.constBegin(); it != Tasks.constEnd(); ++it)
+    {
+        busiest.append(qMakePair(it->totalRunMs, it.key()));
+    }
+    std::sort(busiest.begin(), busiest.end(), [](const QPair<qint64, QString> &a, const QPair<qint64, QString> &b) {
+        return a.first > b.first;
+    });
+
+    QStringList tasks;
+    for (int index = 0; index < std::min(busiest.size(), 5); ++index)
+    {
+        const TaskStats task = Tasks.value(busiest[index].second);
+        const qint64 runs = std::max<qint64>(1, task.runs);
+        tasks << QString("%1 x%2 wait %3/%4 ms run %5/%6 ms")
+            .arg(busiest[index].second)
+            .arg(task.runs)
+            .arg(task.totalQueueMs / runs)
+            .arg(task.maxQueueMs)
+            .arg(task.totalRunMs / runs)
+            .arg(task.maxRunMs);
+    }
+
+    return QString("lanes: %1; busiest: %2").arg(lanes.join(", "), tasks.join(", "));
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2014-2024, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SCHEDULER_TELEMETRY_H
+#define SCHEDULER_TELEMETRY_H
+
+#include <atomic>
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+// Process-wide statistics of FutureScheduler tasks, recorded by the pool threads.
+class SchedulerTelemetry
+{
+public:
+    struct TaskStats
+    {
+        quint64 runs = 0;
+        qint64 totalQueueMs = 0;
+        qint64 maxQueueMs = 0;
+        qint64 totalRunMs = 0;
+        qint64 maxRunMs = 0;
+        int running = 0;
+        int maxRunning = 0;
+    };
+
+    struct LaneStats
+    {
+        int queued = 0;
+        int running = 0;
+    };
+
+    static SchedulerTelemetry &instance();
+
+    void taskQueued(const QString &lane);
+    void taskStarted(const QString &lane, const QString &name, qint64 queueMs);
+    void taskFinished(const QString &lane, const QString &name, qint64 runMs);
+
+    QHash<QString, TaskStats> tasks() const;
+    QHash<QString, LaneStats> lanes() const;
+    void reset();
+
+    // Tasks running longer than the threshold are logged, 0 disables the log.
+    int slowTaskThresholdMs() const;
+    void setSlowTaskThresholdMs(int thresholdMs);
+
+    // One line summary of the busiest lanes and tasks.
+    QString summary() const;
+
+private:
+    SchedulerTelemetry();
+
+private:
+    mutable QMutex Mutex;
+    QHash<QString, TaskStats> Tasks;
+    QHash<QString, LaneStats> Lanes;
+    std::atomic<int> SlowTaskThresholdMs;
+};
+
+#endif // SCHEDULER_TELEMETRY_H
@@ -31,6 +31,7 @@
 #include <QReadLocker>
 #include <QWriteLocker>
 
+#include "HttpClientPool.h"
 #include "updater.h"
 
 namespace
@@ -92,12 +93,11 @@ private:
 Downloader::Downloader(QObject *parent)
     : QObject(parent)
     , m_active(false)
-    , m_httpClient(new HttpClient())
+    , m_loaded(0)
+    , m_total(0)
     , m_network(this)
     , m_scheduler(this)
 {
-    QObject::connect(m_httpClient.get(), SIGNAL(contentLengthChanged()), this, SIGNAL(totalChanged()));
-    QObject::connect(m_httpClient.get(), SIGNAL(receivedChanged()), this, SIGNAL(loadedChanged()));
 }
 
 Downloader::~Downloader()
@@ -107,10 +107,14 @@ Downloader::~Downloader()
 
 void Downloader::cancel()
 {
-    m_httpClient->cancel();
+    m_scheduler.cancelAll();
 
     QWriteLocker locker(&m_mutex);
 
+    if (m_httpClient)
+    {
+        m_httpClient->cancel();
+    }
     m_contents.clear();
 }
 
@@ -134,16 +138,19 @@ bool Downloader::get(const QString &url, const QString &hash, const QJSValue &ca
 
             std::string response;
             {
-                QString error;
-                auto task = m_scheduler.run([this, &error, &response, &url] {
-                    error = m_network.get(m_httpClient, url, response);
-                });
-                if (!task.first)
+                std::shared_ptr<HttpClient> httpClient = HttpClientPool::instance().acquire(QUrl(url), proxyAddress());
+                if (!httpClient)
                 {
-                    return QJSValueList({"failed to start downloading task"});
+                    return QJSValueList({FutureScheduler::cancelled() ? "cancelled" : "failed to initialize a client"});
                 }
-                task.second.waitForFinished();
+                setHttpClient(httpClient);
+                const QString error = m_network.get(httpClient, url, response);
+                setHttpClient(nullptr);
 
+                if (FutureScheduler::cancelled())
+                {
+                    return QJSValueList({"cancelled"});
+                }
                 if (!error.isEmpty())
                 {
                     return QJSValueList({error});
@@ -176,7 +183,10 @@ bool Downloader::get(const QString &url, const QString &hash, const QJSValue &ca
 
             return QJSValueList({});
         },
-        callback);
+        callback,
+        FutureScheduler::Lane::Dedicated,
+        FutureScheduler::Priority_Normal,
+        "download");
 
     return future.first;
 }
@@ -213,12 +223,16 @@ bool Downloader::active() const
 
 quint64 Downloader::loaded() const
 {
-    return m_httpClient->received();
+    QReadLocker locker(&m_mutex);
+
+    return m_httpClient ? m_httpClient->received() : m_loaded;
 }
 
 quint64 Downloader::total() const
 {
-    return m_httpClient->contentLength();
+    QReadLocker locker(&m_mutex);
+
+    return m_httpClient ? m_httpClient->contentLength() : m_total;
 }
 
 QString Downloader::proxyAddress() const
@@ -229,14 +243,35 @@ QString Downloader::proxyAddress() const
 
 void Downloader::setProxyAddress(QString address)
 {
-    m_scheduler.run([this, address] {
-        if (!m_httpClient->set_proxy(address.toStdString()))
+    {
+        QMutexLocker locker(&m_proxyMutex);
+        if (m_proxyAddress == address)
         {
-            qCritical() << "Failed to set proxy address" << address;
+            return;
         }
-
-        QMutexLocker locker(&m_proxyMutex);
         m_proxyAddress = address;
-        emit proxyAddressChanged();
-    });
+    }
+    emit proxyAddressChanged();
+}
+
+void Downloader::setHttpClient(std::shared_ptr<HttpClient> httpClient)
+{
+    {
+        QWriteLocker locker(&m_mutex);
+
+        if (m_httpClient)
+        {
+            QObject::disconnect(m_httpClient.get(), nullptr, this, nullptr);
+            m_loaded = m_httpClient->received();
+            m_total = m_httpClient->contentLength();
+        }
+        m_httpClient = std::move(httpClient);
+        if (m_httpClient)
+        {
+            QObject::connect(m_httpClient.get(), SIGNAL(contentLengthChanged()), this, SIGNAL(totalChanged()));
+            QObject::connect(m_httpClient.get(), SIGNAL(receivedChanged()), this, SIGNAL(loadedChanged()));
+        }
+    }
+    emit totalChanged();
+    emit loadedChanged();
 }
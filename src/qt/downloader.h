@@ -60,11 +60,15 @@ private:
     quint64 total() const;
     QString proxyAddress() const;
     void setProxyAddress(QString address);
+    void setHttpClient(std::shared_ptr<HttpClient> httpClient);
 
 private:
     bool m_active;
     std::string m_contents;
+    // pooled client leased for the running download only
     std::shared_ptr<HttpClient> m_httpClient;
+    quint64 m_loaded;
+    quint64 m_total;
     mutable QReadWriteLock m_mutex;
     Network m_network;
     QString m_proxyAddress;
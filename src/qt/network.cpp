@@ -31,15 +31,18 @@
 #include <QDebug>
 #include <QtCore>
 
+#include "HttpClientPool.h"
 #include "utils.h"
 
 using epee::net_utils::http::fields_list;
 using epee::net_utils::http::http_response_info;
-using epee::net_utils::http::abstract_http_client;
 
 HttpClient::HttpClient(QObject *parent /* = nullptr */)
     : QObject(parent)
     , m_cancel(false)
+    , m_reused(false)
+    , m_responded(false)
+    , m_discarded(false)
     , m_contentLength(0)
     , m_received(0)
 {
@@ -50,6 +53,44 @@ void HttpClient::cancel()
     m_cancel = true;
 }
 
+void HttpClient::reset(bool reused)
+{
+    m_cancel = false;
+    m_reused = reused;
+    m_responded = false;
+    m_discarded = false;
+    m_contentLength = 0;
+    m_received = 0;
+}
+
+bool HttpClient::request(
+    const std::string &uri,
+    const std::string &method,
+    const std::string &body,
+    std::chrono::milliseconds timeout,
+    const http_response_info **response,
+    const fields_list &headers)
+{
+    m_responded = false;
+    bool result = invoke(uri, method, body, timeout, response, headers);
+    if (!result && m_reused && !m_responded && !m_cancel && !FutureScheduler::cancelled())
+    {
+        m_reused = false;
+        disconnect();
+        result = invoke(uri, method, body, timeout, response, headers);
+    }
+    if (!result)
+    {
+        m_discarded = true;
+    }
+    return result;
+}
+
+bool HttpClient::discarded() const
+{
+    return m_discarded;
+}
+
 quint64 HttpClient::contentLength() const
 {
     return m_contentLength;
@@ -62,6 +103,7 @@ quint64 HttpClient::received() const
 
 bool HttpClient::on_header(const http_response_info &headers)
 {
+    m_responded = true;
     if (m_cancel.exchange(false))
     {
         return false;
@@ -100,20 +142,49 @@ Network::Network(QObject *parent)
 {
 }
 
+QString Network::proxyAddress() const
+{
+    QMutexLocker locker(&m_proxyMutex);
+    return m_proxyAddress;
+}
+
+void Network::setProxyAddress(const QString &address)
+{
+    {
+        QMutexLocker locker(&m_proxyMutex);
+        if (m_proxyAddress == address)
+        {
+            return;
+        }
+        m_proxyAddress = address;
+    }
+    emit proxyAddressChanged();
+}
+
 void Network::get(const QString &url, const QJSValue &callback, const QString &contentType /* = {} */) const
 {
     m_scheduler.run(
         [this, url, contentType] {
-            std::shared_ptr<abstract_http_client> httpClient = newClient();
+            if (FutureScheduler::cancelled())
+            {
+                return QJSValueList({url, "", "cancelled"});
+            }
+            std::shared_ptr<HttpClient> httpClient = leaseClient(url);
             if (httpClient.get() == nullptr)
             {
-                return QJSValueList({url, "", "failed to initialize a client"});
+                return QJSValueList({url, "", FutureScheduler::cancelled() ? "cancelled" : "failed to initialize a client"});
             }
             std::string response;
             QString error = get(httpClient, url, response, contentType);
             return QJSValueList({url, QString::fromStdString(response), error});
         },
-        callback);
+        callback,
+        FutureScheduler::Lane::Background);
+}
+
+void Network::cancel() const
+{
+    m_scheduler.cancelAll();
 }
 
 void Network::getJSON(const QString &url, const QJSValue &callback) const
@@ -124,7 +195,7 @@ void Network::getJSON(const QString &url, const QJSValue &callback) const
 std::string Network::get(const QString &url, const QString &contentType /* = {} */) const
 {
     std::string response;
-    std::shared_ptr<abstract_http_client> httpClient = newClient();
+    std::shared_ptr<HttpClient> httpClient = leaseClient(url);
     if (httpClient.get() == nullptr)
     {
         throw std::runtime_error("failed to initialize a client");
@@ -138,14 +209,12 @@ std::string Network::get(const QString &url, const QString &contentType /* = {}
 }
 
 QString Network::get(
-    std::shared_ptr<abstract_http_client> httpClient,
+    std::shared_ptr<HttpClient> httpClient,
     const QString &url,
     std::string &response,
     const QString &contentType /* = {} */) const
 {
     const QUrl urlParsed(url);
-    httpClient->set_server(urlParsed.host().toStdString(), urlParsed.scheme() == "https" ? "443" : "80", {});
-
     const QString uri = (urlParsed.hasQuery() ? urlParsed.path() + "?" + urlParsed.query() : urlParsed.path());
     const http_response_info *pri = NULL;
     constexpr std::chrono::milliseconds timeout = std::chrono::seconds(15);
@@ -155,7 +224,7 @@ QString Network::get(
     {
         headers.push_back({"Content-Type", contentType.toStdString()});
     }
-    const bool result = httpClient->invoke(uri.toStdString(), "GET", {}, timeout, std::addressof(pri), headers);
+    const bool result = httpClient->request(uri.toStdString(), "GET", {}, timeout, std::addressof(pri), headers);
     if (!result)
     {
         return "unknown error";
@@ -173,12 +242,7 @@ QString Network::get(
     return {};
 }
 
-std::shared_ptr<abstract_http_client> Network::newClient() const
+std::shared_ptr<HttpClient> Network::leaseClient(const QString &url) const
 {
-    std::shared_ptr<abstract_http_client> client(new net::http::client());
-    if (!client->set_proxy(m_proxyAddress.toStdString()))
-    {
-        throw std::runtime_error("failed to set proxy address");
-    }
-    return client;
+    return HttpClientPool::instance().acquire(QUrl(url), proxyAddress());
 }
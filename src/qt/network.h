@@ -50,6 +50,21 @@ public:
     HttpClient(QObject *parent = nullptr);
 
     void cancel();
+    // Clears the cancellation flag and the progress left over by a previous lease, reused tells
+    // whether the connection already served one.
+    void reset(bool reused);
+    // invoke() that repeats the request once on a fresh connection if a reused keep-alive one fails
+    // before any response arrives, the server likely closed it while it was idle. Cancelled or
+    // half-received requests are never repeated. Any failure marks the client as discarded.
+    bool request(
+        const std::string &uri,
+        const std::string &method,
+        const std::string &body,
+        std::chrono::milliseconds timeout,
+        const epee::net_utils::http::http_response_info **response,
+        const epee::net_utils::http::fields_list &headers);
+    // The connection is in an unknown state, it must not serve another request.
+    bool discarded() const;
     quint64 contentLength() const;
     quint64 received() const;
 
@@ -63,6 +78,10 @@ protected:
 
 private:
     std::atomic<bool> m_cancel;
+    bool m_reused;
+    // the current request got its response headers
+    std::atomic<bool> m_responded;
+    bool m_discarded;
     std::atomic<size_t> m_contentLength;
     std::atomic<size_t> m_received;
 };
@@ -70,18 +89,24 @@ private:
 class Network : public QObject
 {
     Q_OBJECT
-    Q_PROPERTY(QString proxyAddress MEMBER m_proxyAddress NOTIFY proxyAddressChanged)
+    Q_PROPERTY(QString proxyAddress READ proxyAddress WRITE setProxyAddress NOTIFY proxyAddressChanged)
 
 public:
     Network(QObject *parent = nullptr);
 
+    QString proxyAddress() const;
+    void setProxyAddress(const QString &address);
+
 public:
     Q_INVOKABLE void get(const QString &url, const QJSValue &callback, const QString &contentType = {}) const;
     Q_INVOKABLE void getJSON(const QString &url, const QJSValue &callback) const;
+    // Cancels the pending requests, their callbacks are not called.
+    Q_INVOKABLE void cancel() const;
 
     std::string get(const QString &url, const QString &contentType = {}) const;
+    // httpClient must already be bound to the url host, see HttpClientPool.
     QString get(
-        std::shared_ptr<epee::net_utils::http::abstract_http_client> httpClient,
+        std::shared_ptr<HttpClient> httpClient,
         const QString &url,
         std::string &response,
         const QString &contentType = {}) const;
@@ -90,9 +115,10 @@ signals:
     void proxyAddressChanged() const;
 
 private:
-    std::shared_ptr<epee::net_utils::http::abstract_http_client> newClient() const;
+    std::shared_ptr<HttpClient> leaseClient(const QString &url) const;
 
 private:
     QString m_proxyAddress;
+    mutable QMutex m_proxyMutex;
     mutable FutureScheduler m_scheduler;
 };
@@ -49,12 +49,14 @@ Updater::Updater()
 QByteArray Updater::fetchSignedHash(
     const QString &binaryFilename,
     const QByteArray &hashFromDns,
-    QPair<QString, QString> &signers) const
+    QPair<QString, QString> &signers,
+    const QString &proxyAddress /* = {} */) const
 {
     static constexpr const char hashesTxtUrl[] = "https://web.getmonero.org/downloads/hashes.txt";
     static constexpr const char hashesTxtSigUrl[] = "https://web.getmonero.org/downloads/hashes.txt.sig";
 
-    const Network network;
+    Network network;
+    network.setProxyAddress(proxyAddress);
     std::string hashesTxt = network.get(hashesTxtUrl);
     std::string hashesTxtSig = network.get(hashesTxtSigUrl);
 
@@ -40,7 +40,8 @@ public:
     QByteArray fetchSignedHash(
         const QString &binaryFilename,
         const QByteArray &hashFromDns,
-        QPair<QString, QString> &signers) const;
+        QPair<QString, QString> &signers,
+        const QString &proxyAddress = {}) const;
     QByteArray getHash(const void *data, size_t size) const;
     QPair<QString, QString> verifySignaturesAndHashSum(
         const QByteArray &armoredSignedHashes,